@@ -0,0 +1,35 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace bench {
+
+namespace {
+
+std::atomic<size_t> allocation_count = 0;
+
+}  // namespace
+
+size_t GetAllocationCount() {
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+}  // namespace bench
+
+void* operator new(std::size_t size) {
+    bench::allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* result = std::malloc(size != 0 ? size : 1)) {
+        return result;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
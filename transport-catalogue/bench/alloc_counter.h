@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+namespace bench {
+
+// Число вызовов глобального operator new с начала работы программы. Счётчик
+// ведёт замена operator new в alloc_counter.cpp.
+size_t GetAllocationCount();
+
+}  // namespace bench
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string_view>
+
+namespace bench {
+
+// Лучшее из repeat времён выполнения f в миллисекундах: минимум меньше
+// всего зависит от фоновой нагрузки.
+template <typename Function>
+double MeasureMs(int repeat, Function&& f) {
+    double best = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < repeat; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+// Строка результата: что измерялось, время и отношение к базовому варианту.
+inline void Report(std::string_view name, double ms, double baseline_ms) {
+    std::cout << "  " << std::left << std::setw(44) << name << std::right << std::fixed
+              << std::setprecision(3) << std::setw(12) << ms << " ms" << std::setprecision(2)
+              << std::setw(9) << baseline_ms / ms << "x\n";
+}
+
+// Не даёт компилятору выбросить вычисление, результат которого не используется.
+template <typename T>
+void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace bench
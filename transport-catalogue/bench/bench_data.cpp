@@ -0,0 +1,73 @@
+#include "bench_data.h"
+
+#include <charconv>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace std::literals;
+
+namespace bench {
+
+namespace {
+
+void AppendNumber(std::string& out, double value) {
+    char buffer[32];
+    out.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+}
+
+}  // namespace
+
+std::string MakeBaseDocument(int stop_count, int bus_count, int stops_per_bus, uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> random_stop(0, stop_count - 1);
+    std::uniform_int_distribution<int> random_distance(100, 5000);
+    std::uniform_real_distribution<double> offset(-0.3, 0.3);
+
+    std::vector<std::vector<int>> buses(bus_count);
+    std::vector<std::map<int, int>> distances(stop_count);
+    for (auto& bus : buses) {
+        for (int i = 0; i < stops_per_bus; ++i) {
+            bus.push_back(random_stop(generator));
+        }
+        for (int i = 0; i + 1 < stops_per_bus; ++i) {
+            distances[bus[i]].emplace(bus[i + 1], random_distance(generator));
+        }
+    }
+
+    std::string out = "{\"base_requests\": ["s;
+    for (int i = 0; i < stop_count; ++i) {
+        out += i != 0 ? ", "sv : ""sv;
+        out += "{\"type\": \"Stop\", \"name\": \"Stop "sv;
+        out += std::to_string(i);
+        out += "\", \"latitude\": "sv;
+        AppendNumber(out, 55.75 + offset(generator));
+        out += ", \"longitude\": "sv;
+        AppendNumber(out, 37.6 + offset(generator));
+        out += ", \"road_distances\": {"sv;
+        bool is_first = true;
+        for (const auto& [to, distance] : distances[i]) {
+            out += is_first ? "\"Stop "sv : ", \"Stop "sv;
+            out += std::to_string(to);
+            out += "\": "sv;
+            out += std::to_string(distance);
+            is_first = false;
+        }
+        out += "}}"sv;
+    }
+    for (int i = 0; i < bus_count; ++i) {
+        out += ", {\"type\": \"Bus\", \"name\": \"Bus "sv;
+        out += std::to_string(i);
+        out += "\", \"stops\": ["sv;
+        for (size_t j = 0; j < buses[i].size(); ++j) {
+            out += j != 0 ? ", \"Stop "sv : "\"Stop "sv;
+            out += std::to_string(buses[i][j]);
+            out += "\""sv;
+        }
+        out += "], \"is_roundtrip\": false}"sv;
+    }
+    out += "]}"sv;
+    return out;
+}
+
+}  // namespace bench
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace bench {
+
+// Документ с base_requests на stop_count остановок и bus_count автобусов по
+// stops_per_bus остановок, с расстояниями для всех перегонов, в том виде,
+// в каком его получает make_base. Остановки разбросаны по окрестности Москвы.
+std::string MakeBaseDocument(int stop_count, int bus_count, int stops_per_bus, uint32_t seed = 1);
+
+}  // namespace bench
@@ -0,0 +1,16 @@
+#pragma once
+
+namespace bench {
+
+// Каждый замер печатает заголовок и строки Report; базовый вариант - первый.
+void BenchJsonLoad();
+void BenchDom();
+void BenchNumbers();
+void BenchRouteDistances();
+void BenchNameLookup();
+void BenchThreadScaling();
+void BenchSvgOutput();
+void BenchRouteLength();
+void BenchRouterBuild();
+
+}  // namespace bench
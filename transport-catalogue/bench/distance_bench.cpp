@@ -0,0 +1,126 @@
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "benchmarks.h"
+#include "transport_catalogue.h"
+
+namespace bench {
+
+namespace {
+
+using transport_catalogue::StopId;
+
+// Прежнее хранилище: хеш-таблица по паре остановок.
+struct StopPairHasher {
+    size_t operator()(const std::pair<StopId, StopId>& stops) const {
+        return std::hash<StopId>{}(stops.first) + std::hash<StopId>{}(stops.second) * 37;
+    }
+};
+
+using DistanceMap = std::unordered_map<std::pair<StopId, StopId>, int, StopPairHasher>;
+
+int FindDistance(const DistanceMap& distances, StopId from, StopId to) {
+    if (const auto it = distances.find({from, to}); it != distances.end()) {
+        return it->second;
+    }
+    return distances.at({to, from});
+}
+
+}  // namespace
+
+// Длины длинных маршрутов по расстояниям в CSR-индексе и по
+// заранее разложенным перегонам против хеш-таблицы пар остановок.
+void BenchRouteDistances() {
+    const int stop_count = 5000;
+    const int bus_count = 40;
+    const int stops_per_bus = 3000;
+    std::mt19937 generator(9);
+    std::uniform_int_distribution<StopId> stop(0, stop_count - 1);
+    std::uniform_int_distribution<int> distance(100, 5000);
+
+    transport_catalogue::TransportCatalogue catalogue;
+    for (int i = 0; i < stop_count; ++i) {
+        catalogue.AddStop("Stop " + std::to_string(i), {55.5 + i * 1e-4, 37.5 + i * 1e-4});
+    }
+    DistanceMap distances;
+    std::vector<std::vector<StopId>> routes(bus_count);
+    for (int i = 0; i < bus_count; ++i) {
+        std::vector<StopId>& route = routes[i];
+        route.push_back(stop(generator));
+        while (route.size() < stops_per_bus) {
+            const StopId next = stop(generator);
+            if (next == route.back()) {
+                continue;
+            }
+            const int value = distance(generator);
+            catalogue.AddDistanceStops(route.back(), next, value);
+            distances[{route.back(), next}] = value;
+            route.push_back(next);
+        }
+        catalogue.AddBus("Bus " + std::to_string(i), route, false);
+    }
+    catalogue.Freeze();
+
+    const int repeat = 20;
+    const auto full_routes = [&](auto&& f) {
+        long long total = 0;
+        for (const transport_catalogue::Bus& bus : catalogue.GetBuses()) {
+            const auto route = catalogue.GetRoute(bus);
+            for (size_t i = 0; i + 1 < route.size(); ++i) {
+                total += f(route[i], route[i + 1]);
+            }
+        }
+        return total;
+    };
+    const long long expected = full_routes([&](StopId from, StopId to) {
+        return FindDistance(distances, from, to);
+    });
+
+    long long total = 0;
+    const double map_ms = MeasureMs(repeat, [&] {
+        total = full_routes([&](StopId from, StopId to) {
+            return FindDistance(distances, from, to);
+        });
+        DoNotOptimize(total);
+    });
+    const double csr_ms = MeasureMs(repeat, [&] {
+        total = full_routes([&](StopId from, StopId to) {
+            return catalogue.GetDistanceStops(from, to);
+        });
+        DoNotOptimize(total);
+    });
+    if (total != expected) {
+        throw std::logic_error("Route lengths disagree");
+    }
+    const double spans_ms = MeasureMs(repeat, [&] {
+        total = 0;
+        for (const transport_catalogue::Bus& bus : catalogue.GetBuses()) {
+            for (const int value : catalogue.GetRouteDistances(bus)) {
+                total += value;
+            }
+        }
+        DoNotOptimize(total);
+    });
+    if (total != expected) {
+        throw std::logic_error("Route lengths disagree");
+    }
+
+    // Узел хеш-таблицы: указатель на следующий, ключ, значение и закэшированный
+    // хеш; индекс: смещения по остановкам и пара (куда, сколько) на расстояние.
+    const size_t map_bytes = distances.size() * (sizeof(void*) * 2 + sizeof(DistanceMap::value_type))
+                             + distances.bucket_count() * sizeof(void*);
+    const size_t csr_bytes = (stop_count + 1) * sizeof(uint32_t) + distances.size() * (sizeof(StopId) + sizeof(int));
+    std::cout << "  " << bus_count << " routes of " << stops_per_bus << " stops, " << distances.size()
+              << " distances: unordered_map ~" << map_bytes / 1024 << " KB, CSR index ~" << csr_bytes / 1024 << " KB\n";
+    Report("unordered_map of stop pairs", map_ms, map_ms);
+    Report("GetDistanceStops, CSR index", csr_ms, map_ms);
+    Report("GetRouteDistances", spans_ms, map_ms);
+}
+
+}  // namespace bench
@@ -0,0 +1,155 @@
+#include <map>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "bench.h"
+#include "bench_data.h"
+#include "benchmarks.h"
+#include "json.h"
+
+using namespace std::literals;
+
+namespace bench {
+
+namespace {
+
+// Прежнее устройство дерева: словарь - std::map с узлом на каждый ключ.
+struct MapNode;
+using MapDict = std::map<std::string, MapNode, std::less<>>;
+using MapArray = std::vector<MapNode>;
+
+struct MapNode {
+    MapNode() = default;
+    template <typename Value>
+    MapNode(Value&& value)
+        : value(std::forward<Value>(value)) {
+    }
+
+    std::variant<std::nullptr_t, MapArray, MapDict, bool, int, double, std::string> value;
+};
+
+// Строит MapNode из тех же событий разбора, что и json::DomBuilder, чтобы
+// сравнивалось только устройство дерева.
+class MapDomBuilder final : public json::Handler {
+public:
+    void Null() override {
+        AddValue(nullptr);
+    }
+    void Bool(bool value) override {
+        AddValue(value);
+    }
+    void Int(int value) override {
+        AddValue(value);
+    }
+    void Double(double value) override {
+        AddValue(value);
+    }
+    void String(std::string&& value) override {
+        AddValue(std::move(value));
+    }
+    void StartDict() override {
+        stack_.emplace_back(MapDict{});
+    }
+    void Key(std::string&& key) override {
+        keys_.push_back(std::move(key));
+    }
+    void EndDict() override {
+        Close();
+    }
+    void StartArray() override {
+        stack_.emplace_back(MapArray{});
+    }
+    void EndArray() override {
+        Close();
+    }
+
+    MapNode Extract() {
+        return std::move(root_);
+    }
+
+private:
+    void Close() {
+        MapNode node = std::move(stack_.back());
+        stack_.pop_back();
+        AddValue(std::move(node));
+    }
+
+    void AddValue(MapNode&& node) {
+        if (stack_.empty()) {
+            root_ = std::move(node);
+        } else if (auto* array = std::get_if<MapArray>(&stack_.back().value)) {
+            array->push_back(std::move(node));
+        } else {
+            std::get<MapDict>(stack_.back().value).emplace(std::move(keys_.back()), std::move(node));
+            keys_.pop_back();
+        }
+    }
+
+    std::vector<MapNode> stack_;
+    std::vector<std::string> keys_;
+    MapNode root_;
+};
+
+template <typename Function>
+size_t CountAllocations(Function&& f) {
+    const size_t before = GetAllocationCount();
+    f();
+    return GetAllocationCount() - before;
+}
+
+}  // namespace
+
+// Дерево base_requests на json::Dict (упорядоченный массив пар)
+// против прежнего std::map: аллокации, время построения и поиск ключей.
+void BenchDom() {
+    const std::string text = MakeBaseDocument(20000, 1000, 30);
+    const int repeat = 5;
+
+    size_t map_allocations = 0;
+    size_t dict_allocations = 0;
+    const double map_ms = MeasureMs(repeat, [&] {
+        map_allocations = CountAllocations([&] {
+            MapDomBuilder builder;
+            json::Parse(std::string_view(text), builder);
+            DoNotOptimize(builder.Extract());
+        });
+    });
+    const double dict_ms = MeasureMs(repeat, [&] {
+        dict_allocations = CountAllocations([&] {
+            DoNotOptimize(json::Load(std::string_view(text)));
+        });
+    });
+    std::cout << "  allocations: std::map " << map_allocations << ", json::Dict " << dict_allocations << '\n';
+    Report("parse into std::map DOM", map_ms, map_ms);
+    Report("parse into json::Dict DOM", dict_ms, map_ms);
+
+    // Поиск ключей в каждом запросе, как при загрузке справочника.
+    MapDomBuilder builder;
+    json::Parse(std::string_view(text), builder);
+    const MapNode map_root = builder.Extract();
+    const json::Document document = json::Load(std::string_view(text));
+    const double map_lookup_ms = MeasureMs(repeat, [&] {
+        size_t found = 0;
+        const auto& requests = std::get<MapArray>(std::get<MapDict>(map_root.value).at("base_requests"s).value);
+        for (const MapNode& request : requests) {
+            const MapDict& dict = std::get<MapDict>(request.value);
+            found += dict.count("type"sv) + dict.count("name"sv) + dict.count("road_distances"sv) + dict.count("stops"sv);
+        }
+        DoNotOptimize(found);
+    });
+    const double dict_lookup_ms = MeasureMs(repeat, [&] {
+        size_t found = 0;
+        for (const json::Node& request : document.GetRoot().AsMap().at("base_requests"sv).AsArray()) {
+            const json::Dict& dict = request.AsMap();
+            found += dict.count("type"sv) + dict.count("name"sv) + dict.count("road_distances"sv) + dict.count("stops"sv);
+        }
+        DoNotOptimize(found);
+    });
+    Report("key lookups, std::map", map_lookup_ms, map_lookup_ms);
+    Report("key lookups, json::Dict", dict_lookup_ms, map_lookup_ms);
+}
+
+}  // namespace bench
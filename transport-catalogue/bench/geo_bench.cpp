@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "benchmarks.h"
+#include "geo.h"
+
+namespace bench {
+
+// Длины маршрутов из тысяч остановок скалярной geo::ComputeDistance
+// по координатам и по таблице синусов и косинусов TrigTable.
+void BenchRouteLength() {
+    const int stop_count = 10000;
+    const int route_count = 50;
+    const int stops_per_route = 5000;
+    std::mt19937 generator(21);
+    std::uniform_real_distribution<double> offset(-0.3, 0.3);
+    std::uniform_int_distribution<uint32_t> stop(0, stop_count - 1);
+
+    std::vector<geo::Coordinates> coordinates;
+    geo::TrigTable trig;
+    for (int i = 0; i < stop_count; ++i) {
+        coordinates.push_back({55.75 + offset(generator), 37.6 + offset(generator)});
+        trig.Add(coordinates.back());
+    }
+    std::vector<std::vector<uint32_t>> routes(route_count);
+    for (auto& route : routes) {
+        for (int i = 0; i < stops_per_route; ++i) {
+            route.push_back(stop(generator));
+        }
+    }
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    std::cout << "  AVX2 path: " << (__builtin_cpu_supports("avx2") ? "on" : "off (CPU has no AVX2)") << '\n';
+#else
+    std::cout << "  AVX2 path: off (not x86-64)\n";
+#endif
+    const int repeat = 10;
+    std::vector<double> scalar_lengths(route_count);
+    std::vector<double> table_lengths(route_count);
+    const double scalar_ms = MeasureMs(repeat, [&] {
+        for (size_t r = 0; r < routes.size(); ++r) {
+            double length = 0.;
+            for (size_t i = 0; i + 1 < routes[r].size(); ++i) {
+                length += geo::ComputeDistance(coordinates[routes[r][i]], coordinates[routes[r][i + 1]]);
+            }
+            scalar_lengths[r] = length;
+        }
+        DoNotOptimize(scalar_lengths.data());
+    });
+    const double pairs_ms = MeasureMs(repeat, [&] {
+        double total = 0.;
+        for (const auto& route : routes) {
+            for (size_t i = 0; i + 1 < route.size(); ++i) {
+                total += trig.ComputeDistance(route[i], route[i + 1]);
+            }
+        }
+        DoNotOptimize(total);
+    });
+    const double route_ms = MeasureMs(repeat, [&] {
+        for (size_t r = 0; r < routes.size(); ++r) {
+            table_lengths[r] = trig.ComputeRouteLength(routes[r]);
+        }
+        DoNotOptimize(table_lengths.data());
+    });
+
+    double max_error = 0.;
+    for (int r = 0; r < route_count; ++r) {
+        max_error = std::max(max_error, std::abs(scalar_lengths[r] - table_lengths[r]) / scalar_lengths[r]);
+    }
+    std::cout << "  " << route_count << " routes of " << stops_per_route
+              << " stops, max relative difference " << max_error << '\n';
+    Report("geo::ComputeDistance per segment", scalar_ms, scalar_ms);
+    Report("TrigTable::ComputeDistance per segment", pairs_ms, scalar_ms);
+    Report("TrigTable::ComputeRouteLength", route_ms, scalar_ms);
+}
+
+}  // namespace bench
@@ -0,0 +1,62 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "bench.h"
+#include "bench_data.h"
+#include "benchmarks.h"
+#include "json.h"
+#include "legacy_json.h"
+
+namespace bench {
+
+namespace {
+
+// Принимает события разбора и ничего не строит - чистая стоимость разбора.
+class NullHandler final : public json::Handler {
+public:
+    void Null() override {}
+    void Bool(bool) override {}
+    void Int(int) override {}
+    void Double(double) override {}
+    void String(std::string&&) override {}
+    void StartDict() override {}
+    void Key(std::string&&) override {}
+    void EndDict() override {}
+    void StartArray() override {}
+    void EndArray() override {}
+};
+
+}  // namespace
+
+// Разбор base_requests прежним посимвольным парсером из потока и
+// нынешним - из потока блоками и из буфера.
+void BenchJsonLoad() {
+    const std::string text = MakeBaseDocument(20000, 1000, 30);
+    std::cout << "  document: " << text.size() / 1024 << " KB\n";
+
+    std::istringstream check_input(text);
+    if (!(legacy::Load(check_input) == json::Load(std::string_view(text)).GetRoot())) {
+        throw std::logic_error("Parsers disagree");
+    }
+
+    const int repeat = 5;
+    const double legacy_ms = MeasureMs(repeat, [&] {
+        std::istringstream input(text);
+        DoNotOptimize(legacy::Load(input));
+    });
+    Report("legacy istream peek/get/putback", legacy_ms, legacy_ms);
+    Report("json::Load(istream), 64 KB blocks", MeasureMs(repeat, [&] {
+        std::istringstream input(text);
+        DoNotOptimize(json::Load(input));
+    }), legacy_ms);
+    Report("json::Load(string_view)", MeasureMs(repeat, [&] {
+        DoNotOptimize(json::Load(std::string_view(text)));
+    }), legacy_ms);
+    Report("json::Parse(string_view), no DOM", MeasureMs(repeat, [&] {
+        NullHandler handler;
+        json::Parse(std::string_view(text), handler);
+    }), legacy_ms);
+}
+
+}  // namespace bench
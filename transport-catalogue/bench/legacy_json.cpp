@@ -0,0 +1,191 @@
+#include "legacy_json.h"
+
+#include <cctype>
+#include <iterator>
+#include <string>
+
+using namespace std::literals;
+
+namespace bench::legacy {
+
+namespace {
+
+using json::Array;
+using json::Dict;
+using json::Node;
+using json::ParsingError;
+
+Node LoadNode(std::istream& input);
+
+Node LoadNumber(std::istream& input) {
+    std::string parsed_num;
+
+    auto read_char = [&parsed_num, &input] {
+        parsed_num += static_cast<char>(input.get());
+        if (!input) {
+            throw ParsingError("Failed to read number from stream"s);
+        }
+    };
+
+    auto read_digits = [&input, read_char] {
+        if (!std::isdigit(input.peek())) {
+            throw ParsingError("A digit is expected"s);
+        }
+        while (std::isdigit(input.peek())) {
+            read_char();
+        }
+    };
+
+    if (input.peek() == '-') {
+        read_char();
+    }
+    if (input.peek() == '0') {
+        read_char();
+    } else {
+        read_digits();
+    }
+
+    bool is_int = true;
+    if (input.peek() == '.') {
+        read_char();
+        read_digits();
+        is_int = false;
+    }
+    if (int ch = input.peek(); ch == 'e' || ch == 'E') {
+        read_char();
+        if (ch = input.peek(); ch == '+' || ch == '-') {
+            read_char();
+        }
+        read_digits();
+        is_int = false;
+    }
+
+    try {
+        if (is_int) {
+            try {
+                return Node(std::stoi(parsed_num));
+            } catch (...) {
+            }
+        }
+        return Node(std::stod(parsed_num));
+    } catch (...) {
+        throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
+    }
+}
+
+std::string LoadString(std::istream& input) {
+    auto it = std::istreambuf_iterator<char>(input);
+    auto end = std::istreambuf_iterator<char>();
+    std::string s;
+    while (true) {
+        if (it == end) {
+            throw ParsingError("String parsing error");
+        }
+        const char ch = *it;
+        if (ch == '"') {
+            ++it;
+            break;
+        } else if (ch == '\\') {
+            ++it;
+            if (it == end) {
+                throw ParsingError("String parsing error");
+            }
+            switch (const char escaped_char = *it) {
+                case 'n':
+                    s.push_back('\n');
+                    break;
+                case 't':
+                    s.push_back('\t');
+                    break;
+                case 'r':
+                    s.push_back('\r');
+                    break;
+                case '"':
+                    s.push_back('"');
+                    break;
+                case '\\':
+                    s.push_back('\\');
+                    break;
+                default:
+                    throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
+            }
+        } else if (ch == '\n' || ch == '\r') {
+            throw ParsingError("Unexpected end of line"s);
+        } else {
+            s.push_back(ch);
+        }
+        ++it;
+    }
+    return s;
+}
+
+Node LoadArray(std::istream& input) {
+    Array result;
+    if (input.peek() == -1) {
+        throw ParsingError("Array parsing error");
+    }
+    for (char c; input >> c && c != ']';) {
+        if (c != ',') {
+            input.putback(c);
+        }
+        result.push_back(LoadNode(input));
+    }
+    return Node(std::move(result));
+}
+
+Node LoadWord(std::istream& input, std::string_view word, Node value) {
+    for (const char expected : word) {
+        if (input.peek() != expected) {
+            throw ParsingError("Word parsing error");
+        }
+        input.get();
+    }
+    if (std::isalpha(input.peek())) {
+        throw ParsingError("Word parsing error");
+    }
+    return value;
+}
+
+Node LoadDict(std::istream& input) {
+    Dict result;
+    if (input.peek() == -1) {
+        throw ParsingError("Dict parsing error");
+    }
+    for (char c; input >> c && c != '}';) {
+        if (c == ',') {
+            input >> c;
+        }
+        std::string key = LoadString(input);
+        input >> c;
+        result.insert({std::move(key), LoadNode(input)});
+    }
+    return Node(std::move(result));
+}
+
+Node LoadNode(std::istream& input) {
+    char c;
+    input >> c;
+    if (c == 'n') {
+        input.putback(c);
+        return LoadWord(input, "null"sv, nullptr);
+    } else if (c == '"') {
+        return LoadString(input);
+    } else if (c == 't' || c == 'f') {
+        input.putback(c);
+        return LoadWord(input, c == 't' ? "true"sv : "false"sv, c == 't');
+    } else if (c == '[') {
+        return LoadArray(input);
+    } else if (c == '{') {
+        return LoadDict(input);
+    }
+    input.putback(c);
+    return LoadNumber(input);
+}
+
+}  // namespace
+
+json::Node Load(std::istream& input) {
+    return LoadNode(input);
+}
+
+}  // namespace bench::legacy
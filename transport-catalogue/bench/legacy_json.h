@@ -0,0 +1,13 @@
+#pragma once
+
+#include <istream>
+
+#include "json.h"
+
+namespace bench::legacy {
+
+// Прежний разбор JSON посимвольно через peek/get/putback потока, оставленный
+// как база для сравнения. Строит то же дерево, что json::Load.
+json::Node Load(std::istream& input);
+
+}  // namespace bench::legacy
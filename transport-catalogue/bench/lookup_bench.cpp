@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "bench.h"
+#include "benchmarks.h"
+#include "transport_catalogue.h"
+
+namespace bench {
+
+namespace {
+
+void FillCatalogue(transport_catalogue::TransportCatalogue& catalogue, const std::vector<std::string>& names) {
+    for (size_t i = 0; i < names.size(); ++i) {
+        catalogue.AddStop(names[i], {55.5 + i * 1e-5, 37.5});
+    }
+}
+
+}  // namespace
+
+// Поиск остановки по названию в замороженном справочнике
+// (совершенный хеш), в незамороженном (пул названий) и в unordered_map,
+// как было раньше, - удачный и неудачный.
+void BenchNameLookup() {
+    const int stop_count = 50000;
+    std::vector<std::string> names;
+    for (int i = 0; i < stop_count; ++i) {
+        names.push_back("Stop " + std::to_string(i) + " street");
+    }
+    std::vector<std::string> hits = names;
+    std::shuffle(hits.begin(), hits.end(), std::mt19937(13));
+    std::vector<std::string> misses;
+    for (int i = 0; i < stop_count; ++i) {
+        misses.push_back("Stop " + std::to_string(i) + " avenue");
+    }
+
+    transport_catalogue::TransportCatalogue frozen;
+    FillCatalogue(frozen, names);
+    frozen.Freeze();
+    transport_catalogue::TransportCatalogue mutable_catalogue;
+    FillCatalogue(mutable_catalogue, names);
+    std::unordered_map<std::string_view, const transport_catalogue::Stop*> stop_by_name;
+    for (const std::string& name : names) {
+        stop_by_name.emplace(name, frozen.SearchStop(name));
+    }
+
+    const int repeat = 10;
+    const auto measure = [&](const std::vector<std::string>& queries, auto&& search) {
+        return MeasureMs(repeat, [&] {
+            size_t found = 0;
+            for (const std::string& query : queries) {
+                found += search(query) != nullptr;
+            }
+            if (found != (&queries == &hits ? queries.size() : 0)) {
+                throw std::logic_error("Lookups disagree");
+            }
+            DoNotOptimize(found);
+        });
+    };
+    const auto search_map = [&](std::string_view name) -> const transport_catalogue::Stop* {
+        const auto it = stop_by_name.find(name);
+        return it != stop_by_name.end() ? it->second : nullptr;
+    };
+    const auto search_frozen = [&](std::string_view name) {
+        return frozen.SearchStop(name);
+    };
+    const auto search_mutable = [&](std::string_view name) {
+        return mutable_catalogue.SearchStop(name);
+    };
+
+    std::cout << "  " << stop_count << " stops, " << stop_count << " queries\n";
+    const double map_hit_ms = measure(hits, search_map);
+    Report("hit, unordered_map", map_hit_ms, map_hit_ms);
+    Report("hit, NamePool (not frozen)", measure(hits, search_mutable), map_hit_ms);
+    Report("hit, PerfectHashIndex (frozen)", measure(hits, search_frozen), map_hit_ms);
+    const double map_miss_ms = measure(misses, search_map);
+    Report("miss, unordered_map", map_miss_ms, map_miss_ms);
+    Report("miss, NamePool (not frozen)", measure(misses, search_mutable), map_miss_ms);
+    Report("miss, PerfectHashIndex (frozen)", measure(misses, search_frozen), map_miss_ms);
+}
+
+}  // namespace bench
@@ -0,0 +1,33 @@
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include <utility>
+
+#include "benchmarks.h"
+
+using namespace std::literals;
+
+// Запускает все замеры или только перечисленные в аргументах по имени.
+int main(int argc, char* argv[]) {
+    const std::pair<std::string_view, std::function<void()>> benchmarks[] = {
+        {"json_load"sv, bench::BenchJsonLoad},
+        {"dom"sv, bench::BenchDom},
+        {"numbers"sv, bench::BenchNumbers},
+        {"route_distances"sv, bench::BenchRouteDistances},
+        {"name_lookup"sv, bench::BenchNameLookup},
+        {"thread_scaling"sv, bench::BenchThreadScaling},
+        {"svg_output"sv, bench::BenchSvgOutput},
+        {"route_length"sv, bench::BenchRouteLength},
+        {"router_build"sv, bench::BenchRouterBuild},
+    };
+    for (const auto& [name, run] : benchmarks) {
+        bool is_selected = argc == 1;
+        for (int i = 1; i < argc; ++i) {
+            is_selected = is_selected || argv[i] == name;
+        }
+        if (is_selected) {
+            std::cout << name << '\n';
+            run();
+        }
+    }
+}
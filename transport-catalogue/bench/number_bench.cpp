@@ -0,0 +1,119 @@
+#include <charconv>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "bench.h"
+#include "benchmarks.h"
+
+namespace bench {
+
+namespace {
+
+// Координаты и расстояния в том виде, в каком они приходят в base_requests.
+struct NumberCorpus {
+    std::vector<std::string> doubles;
+    std::vector<std::string> ints;
+    std::vector<double> values;
+};
+
+NumberCorpus MakeCorpus(size_t size) {
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<double> coordinate(-180., 180.);
+    std::uniform_int_distribution<int> distance(1, 100000);
+    NumberCorpus corpus;
+    for (size_t i = 0; i < size; ++i) {
+        corpus.values.push_back(coordinate(generator));
+        std::ostringstream out;
+        out << std::setprecision(std::numeric_limits<double>::max_digits10) << corpus.values.back();
+        corpus.doubles.push_back(out.str());
+        corpus.ints.push_back(std::to_string(distance(generator)));
+    }
+    return corpus;
+}
+
+}  // namespace
+
+// Разбор и печать чисел через from_chars/to_chars против прежних
+// stoi/stod и вывода double в ostream.
+void BenchNumbers() {
+    const NumberCorpus corpus = MakeCorpus(200000);
+    const int repeat = 5;
+
+    const double stod_ms = MeasureMs(repeat, [&] {
+        double sum = 0.;
+        for (const std::string& text : corpus.doubles) {
+            sum += std::stod(text);
+        }
+        DoNotOptimize(sum);
+    });
+    const double from_chars_ms = MeasureMs(repeat, [&] {
+        double sum = 0.;
+        for (const std::string& text : corpus.doubles) {
+            double value = 0.;
+            std::from_chars(text.data(), text.data() + text.size(), value);
+            sum += value;
+        }
+        DoNotOptimize(sum);
+    });
+    Report("parse double, std::stod", stod_ms, stod_ms);
+    Report("parse double, std::from_chars", from_chars_ms, stod_ms);
+
+    const double stoi_ms = MeasureMs(repeat, [&] {
+        long long sum = 0;
+        for (const std::string& text : corpus.ints) {
+            sum += std::stoi(text);
+        }
+        DoNotOptimize(sum);
+    });
+    const double from_chars_int_ms = MeasureMs(repeat, [&] {
+        long long sum = 0;
+        for (const std::string& text : corpus.ints) {
+            int value = 0;
+            std::from_chars(text.data(), text.data() + text.size(), value);
+            sum += value;
+        }
+        DoNotOptimize(sum);
+    });
+    Report("parse int, std::stoi", stoi_ms, stoi_ms);
+    Report("parse int, std::from_chars", from_chars_int_ms, stoi_ms);
+
+    // Прежний вывод терял разряды; с max_digits10 ostream тоже печатает без
+    // потерь, но не кратчайшую запись.
+    std::ostringstream out;
+    const double ostream_ms = MeasureMs(repeat, [&] {
+        out.str({});
+        for (const double value : corpus.values) {
+            out << value << ',';
+        }
+        DoNotOptimize(out.tellp());
+    });
+    const double ostream_exact_ms = MeasureMs(repeat, [&] {
+        out.str({});
+        out << std::setprecision(std::numeric_limits<double>::max_digits10);
+        for (const double value : corpus.values) {
+            out << value << ',';
+        }
+        out << std::setprecision(6);
+        DoNotOptimize(out.tellp());
+    });
+    const double to_chars_ms = MeasureMs(repeat, [&] {
+        out.str({});
+        char buffer[32];
+        for (const double value : corpus.values) {
+            const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.write(buffer, result.ptr - buffer);
+            out << ',';
+        }
+        DoNotOptimize(out.tellp());
+    });
+    Report("print double, ostream (6 digits, lossy)", ostream_ms, ostream_ms);
+    Report("print double, ostream (17 digits)", ostream_exact_ms, ostream_ms);
+    Report("print double, std::to_chars (shortest)", to_chars_ms, ostream_ms);
+}
+
+}  // namespace bench
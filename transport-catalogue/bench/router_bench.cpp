@@ -0,0 +1,110 @@
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "benchmarks.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+using namespace std::literals;
+
+namespace bench {
+
+namespace {
+
+using transport_catalogue::StopId;
+
+// Сеть размером с город: остановки в узлах квадратной сетки, автобус идёт
+// от случайной остановки к соседним, иногда поворачивая, расстояния между
+// соседями 250-600 м в обе стороны.
+void MakeCity(int side, int bus_count, int stops_per_bus, transport_catalogue::TransportCatalogue& catalogue) {
+    std::mt19937 generator(23);
+    std::uniform_int_distribution<int> random_stop(0, side * side - 1);
+    std::uniform_int_distribution<int> random_direction(0, 3);
+    std::uniform_int_distribution<int> random_distance(250, 600);
+    std::bernoulli_distribution turn(0.3);
+    const int dx[] = {1, 0, -1, 0};
+    const int dy[] = {0, 1, 0, -1};
+
+    for (int i = 0; i < side * side; ++i) {
+        catalogue.AddStop("Stop "s + std::to_string(i), {55.6 + i / side * 0.004, 37.4 + i % side * 0.006});
+    }
+    // Расстояние от остановки i до соседней в направлении d - distances[i * 4 + d].
+    std::vector<int> distances(side * side * 4, 0);
+    std::vector<StopId> route;
+    for (int bus = 0; bus < bus_count; ++bus) {
+        int stop = random_stop(generator);
+        int direction = random_direction(generator);
+        route.assign(1, static_cast<StopId>(stop));
+        while (route.size() < static_cast<size_t>(stops_per_bus)) {
+            if (turn(generator)) {
+                direction = (direction + (turn(generator) ? 1 : 3)) % 4;
+            }
+            const int x = stop % side + dx[direction];
+            const int y = stop / side + dy[direction];
+            if (x < 0 || y < 0 || x >= side || y >= side) {
+                direction = (direction + 2) % 4;
+                continue;
+            }
+            const int next = y * side + x;
+            int& distance = distances[stop * 4 + direction];
+            if (distance == 0) {
+                distance = random_distance(generator);
+                distances[next * 4 + (direction + 2) % 4] = distance;
+                catalogue.AddDistanceStops(static_cast<StopId>(stop), static_cast<StopId>(next), distance);
+                catalogue.AddDistanceStops(static_cast<StopId>(next), static_cast<StopId>(stop), distance);
+            }
+            route.push_back(static_cast<StopId>(next));
+            stop = next;
+        }
+        catalogue.AddBus("Bus "s + std::to_string(bus), route, false);
+    }
+    catalogue.Freeze();
+}
+
+}  // namespace
+
+// Построение иерархии сжатия графа маршрутов для городов растущего размера
+// и запросы Route на самом большом из них.
+void BenchRouterBuild() {
+    const transport_router::RoutingSettings settings{6, 40.};
+    const int stops_per_bus = 40;
+    const int repeat = 3;
+    double baseline_ms = 0.;
+    for (const auto& [side, bus_count] : {std::pair{32, 80}, std::pair{48, 170}, std::pair{64, 300}}) {
+        transport_catalogue::TransportCatalogue catalogue;
+        MakeCity(side, bus_count, stops_per_bus, catalogue);
+        const double build_ms = MeasureMs(repeat, [&] {
+            const transport_router::TransportRouter router(catalogue, settings);
+            DoNotOptimize(router);
+        });
+        baseline_ms = baseline_ms == 0. ? build_ms : baseline_ms;
+
+        const transport_router::TransportRouter router(catalogue, settings);
+        const graph::Router::Hierarchy hierarchy = router.GetHierarchy();
+        std::cout << "  " << side * side << " stops, " << bus_count << " buses of " << stops_per_bus << " stops: "
+                  << hierarchy.forward_offsets.size() - 1 << " vertices, " << hierarchy.arcs.size() << " arcs, "
+                  << hierarchy.core.size() << " in core\n";
+        Report("TransportRouter, "s + std::to_string(side * side) + " stops"s, build_ms, baseline_ms);
+
+        if (side == 64) {
+            std::mt19937 generator(7);
+            std::uniform_int_distribution<StopId> stop(0, static_cast<StopId>(catalogue.GetStopCount() - 1));
+            std::vector<std::pair<std::string_view, std::string_view>> requests;
+            for (int i = 0; i < 1000; ++i) {
+                requests.emplace_back(catalogue.GetStop(stop(generator)).name, catalogue.GetStop(stop(generator)).name);
+            }
+            const double route_ms = MeasureMs(repeat, [&] {
+                for (const auto& [from, to] : requests) {
+                    DoNotOptimize(router.BuildRoute(from, to));
+                }
+            });
+            Report("1000 Route requests, "s + std::to_string(side * side) + " stops"s, route_ms, route_ms);
+        }
+    }
+}
+
+}  // namespace bench
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "bench_data.h"
+#include "benchmarks.h"
+#include "json_reader.h"
+#include "request_handler.h"
+
+using namespace std::literals;
+
+namespace bench {
+
+namespace {
+
+// Число потоков от 1 до числа ядер удвоением, но не меньше 4, чтобы на
+// одном ядре были видны накладные расходы переключения.
+std::vector<size_t> GetThreadCounts() {
+    const size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 4);
+    std::vector<size_t> counts;
+    for (size_t count = 1; count <= max_threads; count *= 2) {
+        counts.push_back(count);
+    }
+    if (counts.back() != max_threads) {
+        counts.push_back(max_threads);
+    }
+    return counts;
+}
+
+std::string ScalingName(std::string_view what, size_t thread_count) {
+    return std::string(what) + ", "s + std::to_string(thread_count) + (thread_count == 1 ? " thread"s : " threads"s);
+}
+
+json::Dict MakeStatRequests(int stop_count, int bus_count, int count) {
+    std::mt19937 generator(16);
+    std::uniform_int_distribution<int> stop(0, stop_count - 1);
+    std::uniform_int_distribution<int> bus(0, bus_count - 1);
+    json::Array requests;
+    for (int id = 0; id < count; ++id) {
+        const std::string stop_name = "Stop "s + std::to_string(stop(generator));
+        if (id % 4 == 0) {
+            requests.emplace_back(json::Dict{{"id"s, id}, {"type"s, "Bus"s},
+                                             {"name"s, "Bus "s + std::to_string(bus(generator))}});
+        } else if (id % 4 == 1) {
+            requests.emplace_back(json::Dict{{"id"s, id}, {"type"s, "Stop"s}, {"name"s, stop_name}});
+        } else {
+            requests.emplace_back(json::Dict{{"id"s, id}, {"type"s, "Route"s}, {"from"s, stop_name},
+                                             {"to"s, "Stop "s + std::to_string(stop(generator))}});
+        }
+    }
+    return json::Dict{
+        {"render_settings"s, json::Dict{
+            {"width"s, 600.}, {"height"s, 400.}, {"padding"s, 50.}, {"line_width"s, 14.}, {"stop_radius"s, 5.},
+            {"bus_label_font_size"s, 20}, {"bus_label_offset"s, json::Array{7., 15.}},
+            {"stop_label_font_size"s, 20}, {"stop_label_offset"s, json::Array{7., -3.}},
+            {"underlayer_color"s, "white"s}, {"underlayer_width"s, 3.},
+            {"color_palette"s, json::Array{"green"s, "red"s}},
+        }},
+        {"stat_requests"s, std::move(requests)},
+    };
+}
+
+}  // namespace
+
+// Выполнение заданий в OrderedExecutor и ответы на stat_requests
+// в зависимости от числа рабочих потоков.
+void BenchThreadScaling() {
+    const std::vector<size_t> thread_counts = GetThreadCounts();
+    std::cout << "  hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    const int repeat = 5;
+
+    // Одинаковые счётные задания по ~50 мкс, результат - короткая строка.
+    request_handler::OrderedExecutor executor(1);
+    const auto task = [](size_t i) {
+        double sum = 0.;
+        for (int j = 0; j < 20000; ++j) {
+            sum += std::sqrt(static_cast<double>(i + j));
+        }
+        return std::to_string(sum);
+    };
+    double baseline_ms = 0.;
+    for (const size_t thread_count : thread_counts) {
+        executor.SetThreadCount(thread_count);
+        const double ms = MeasureMs(repeat, [&] {
+            size_t total = 0;
+            executor.Run(2000, task, [&](const std::string& result) {
+                total += result.size();
+            });
+            DoNotOptimize(total);
+        });
+        baseline_ms = thread_count == 1 ? ms : baseline_ms;
+        Report(ScalingName("2000 tasks"sv, thread_count), ms, baseline_ms);
+    }
+
+    // Плотность сети как в типичных входных данных: короткие маршруты.
+    const int stop_count = 3000;
+    const int bus_count = 400;
+    transport_catalogue::TransportCatalogue catalogue;
+    json_reader::JSONReader reader(catalogue);
+    reader.LoadRequests(MakeBaseDocument(stop_count, bus_count, 6));
+    reader.SetRoutingSettings({6, 40.});
+    const json::Dict requests = MakeStatRequests(stop_count, bus_count, 20000);
+    std::string expected;
+    for (const size_t thread_count : thread_counts) {
+        reader.SetThreadCount(thread_count);
+        std::ostringstream output;
+        const double ms = MeasureMs(repeat, [&] {
+            output.str({});
+            reader.ProcessRequests(requests, output);
+        });
+        if (thread_count == 1) {
+            baseline_ms = ms;
+            expected = output.str();
+        } else if (output.str() != expected) {
+            throw std::logic_error("Answers depend on the thread count");
+        }
+        Report(ScalingName("20000 stat_requests"sv, thread_count), ms, baseline_ms);
+    }
+}
+
+}  // namespace bench
@@ -0,0 +1,183 @@
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "benchmarks.h"
+#include "svg.h"
+
+using namespace std::literals;
+
+namespace bench {
+
+namespace {
+
+// Элементы карты в нейтральном виде, из которого строятся все варианты вывода.
+struct Scene {
+    struct Line {
+        std::vector<svg::Point> points;
+        std::string color;
+    };
+    struct Label {
+        svg::Point position;
+        std::string data;
+    };
+
+    std::vector<Line> lines;
+    std::vector<svg::Point> circles;
+    std::vector<Label> labels;
+};
+
+Scene MakeScene(size_t element_count) {
+    std::mt19937 generator(19);
+    std::uniform_real_distribution<double> coordinate(0., 1000.);
+    const std::string palette[] = {"green"s, "rgb(255,160,0)"s, "red"s};
+    Scene scene;
+    for (size_t i = 0; i < element_count / 10; ++i) {
+        Scene::Line line;
+        for (int j = 0; j < 20; ++j) {
+            line.points.push_back({coordinate(generator), coordinate(generator)});
+        }
+        line.color = palette[i % 3];
+        scene.lines.push_back(std::move(line));
+    }
+    for (size_t i = 0; i < element_count * 9 / 20; ++i) {
+        scene.circles.push_back({coordinate(generator), coordinate(generator)});
+        scene.labels.push_back({{coordinate(generator), coordinate(generator)}, "Stop "s + std::to_string(i)});
+    }
+    return scene;
+}
+
+// Прежний вывод: каждый элемент пишется в поток по частям и завершается std::endl.
+void RenderLegacy(const Scene& scene, std::ostream& out) {
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
+    for (const Scene::Line& line : scene.lines) {
+        out << "  <polyline points=\""sv;
+        bool is_first = true;
+        for (const svg::Point& point : line.points) {
+            out << (is_first ? ""sv : " "sv) << point.x << ","sv << point.y;
+            is_first = false;
+        }
+        out << "\" fill=\"none\" stroke=\""sv << line.color
+            << "\" stroke-width=\"14\" stroke-linecap=\"round\" stroke-linejoin=\"round\"/>"sv << std::endl;
+    }
+    for (const svg::Point& center : scene.circles) {
+        out << "  <circle cx=\""sv << center.x << "\" cy=\""sv << center.y << "\" r=\""sv << 5. << "\" fill=\"white\"/>"sv
+            << std::endl;
+    }
+    for (const Scene::Label& label : scene.labels) {
+        out << "  <text fill=\"black\" x=\""sv << label.position.x << "\" y=\""sv << label.position.y
+            << "\" dx=\""sv << 7. << "\" dy=\""sv << -3. << "\" font-size=\""sv << 20
+            << "\" font-family=\"Verdana\">"sv << label.data << "</text>"sv << std::endl;
+    }
+    out << "</svg>"sv;
+}
+
+svg::PathAttrs MakeLineAttrs(const std::string& color) {
+    svg::PathAttrs attrs;
+    attrs.fill_color = "none"s;
+    attrs.stroke_color = color;
+    attrs.stroke_width = 14.;
+    attrs.stroke_line_cap = svg::StrokeLineCap::ROUND;
+    attrs.stroke_line_join = svg::StrokeLineJoin::ROUND;
+    return attrs;
+}
+
+svg::Document MakeDocument(const Scene& scene) {
+    svg::Document document;
+    for (const Scene::Line& line : scene.lines) {
+        svg::Polyline polyline;
+        for (const svg::Point& point : line.points) {
+            polyline.AddPoint(point);
+        }
+        document.Add(std::move(polyline.SetFillColor("none"s).SetStrokeColor(line.color).SetStrokeWidth(14.)
+                     .SetStrokeLineCap(svg::StrokeLineCap::ROUND).SetStrokeLineJoin(svg::StrokeLineJoin::ROUND)));
+    }
+    for (const svg::Point& center : scene.circles) {
+        document.Add(svg::Circle().SetCenter(center).SetRadius(5.).SetFillColor("white"s));
+    }
+    for (const Scene::Label& label : scene.labels) {
+        document.Add(svg::Text().SetPosition(label.position).SetOffset({7., -3.}).SetFontSize(20)
+                     .SetFontFamily("Verdana"s).SetData(label.data).SetFillColor("black"s));
+    }
+    return document;
+}
+
+svg::FlatDocument MakeFlatDocument(const Scene& scene) {
+    svg::FlatDocument document;
+    for (const Scene::Line& line : scene.lines) {
+        document.StartPolyline(document.AddStyle(MakeLineAttrs(line.color)));
+        for (const svg::Point& point : line.points) {
+            document.AddPoint(point);
+        }
+    }
+    svg::PathAttrs circle_attrs;
+    circle_attrs.fill_color = "white"s;
+    const auto circle_style = document.AddStyle(circle_attrs);
+    for (const svg::Point& center : scene.circles) {
+        document.AddCircle(center, 5., circle_style);
+    }
+    svg::PathAttrs label_attrs;
+    label_attrs.fill_color = "black"s;
+    const auto label_style = document.AddStyle(label_attrs);
+    const auto font = document.AddFont({{7., -3.}, 20, "Verdana"s, ""s});
+    for (const Scene::Label& label : scene.labels) {
+        document.AddText(label.position, label.data, font, label_style);
+    }
+    return document;
+}
+
+}  // namespace
+
+// Построение карты из ~100 тысяч элементов и её вывод в файл
+// прежним способом (ostream и std::endl после каждого элемента) и через
+// общий буфер из svg::Document и svg::FlatDocument.
+void BenchSvgOutput() {
+    const Scene scene = MakeScene(100000);
+    const svg::Document document = MakeDocument(scene);
+    const svg::FlatDocument flat_document = MakeFlatDocument(scene);
+    std::string check_document;
+    std::string check_flat;
+    document.Render(check_document);
+    flat_document.Render(check_flat);
+    if (check_document != check_flat) {
+        throw std::logic_error("Document and FlatDocument disagree");
+    }
+    std::cout << "  " << scene.lines.size() + scene.circles.size() + scene.labels.size() << " elements, "
+              << check_document.size() / 1024 << " KB\n";
+
+    std::ofstream out("/dev/null");
+    const int repeat = 5;
+    const double legacy_ms = MeasureMs(repeat, [&] {
+        RenderLegacy(scene, out);
+    });
+    const double document_ms = MeasureMs(repeat, [&] {
+        document.Render(out);
+    });
+    const double flat_ms = MeasureMs(repeat, [&] {
+        flat_document.Render(out);
+    });
+    std::string buffer;
+    const double buffer_ms = MeasureMs(repeat, [&] {
+        buffer.clear();
+        flat_document.Render(buffer);
+        DoNotOptimize(buffer.size());
+    });
+    const double build_document_ms = MeasureMs(repeat, [&] {
+        DoNotOptimize(MakeDocument(scene));
+    });
+    const double build_flat_ms = MeasureMs(repeat, [&] {
+        DoNotOptimize(MakeFlatDocument(scene));
+    });
+    Report("build svg::Document", build_document_ms, build_document_ms);
+    Report("build svg::FlatDocument", build_flat_ms, build_document_ms);
+    Report("ostream with std::endl per element", legacy_ms, legacy_ms);
+    Report("svg::Document to ostream", document_ms, legacy_ms);
+    Report("svg::FlatDocument to ostream", flat_ms, legacy_ms);
+    Report("svg::FlatDocument to std::string", buffer_ms, legacy_ms);
+}
+
+}  // namespace bench
@@ -1,20 +1,169 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
+#include <utility>
+
+// Ядро AVX2 собирается на x86-64 при любых флагах компилятора, а выбирается
+// во время работы, если его поддерживает процессор.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define GEO_AVX2_KERNEL
+#include <immintrin.h>
+#define GEO_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
 
 namespace geo {
 
+namespace {
+
+constexpr double DR = DEGREES_TO_RADIANS;
+
+#if defined(GEO_AVX2_KERNEL)
+bool HasAvx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+
+// Маскированная выборка с явным нулевым источником: у _mm256_i32gather_pd в
+// GCC 12 он не инициализирован, что даёт ложное предупреждение.
+GEO_TARGET_AVX2 __m256d Gather(const double* base, __m128i index) {
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base, index,
+                                    _mm256_castsi256_pd(_mm256_set1_epi64x(-1)), 8);
+}
+
+// acos(x) для x > 0.5 как 2 * asin(sqrt((1 - x) / 2)); аргумент asin не больше
+// 0.5, и на этом отрезке рациональная аппроксимация из Cephes точна до ulp.
+GEO_TARGET_AVX2 __m256d AcosNearOne(__m256d x) {
+    static constexpr double P[] = {4.253011369004428248960E-3, -6.019598008014123785661E-1,
+                                   5.444622390564711410273E0, -1.626247967210700244449E1,
+                                   1.956261983317594739197E1, -8.198089802484824371615E0};
+    static constexpr double Q[] = {-1.474091372988853791896E1, 7.049610280856842141659E1,
+                                   -1.471791292232726029859E2, 1.395105614657485689735E2,
+                                   -4.918853881490881290097E1};
+    const __m256d a = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_set1_pd(1.), x), _mm256_set1_pd(0.5)));
+    const __m256d z = _mm256_mul_pd(a, a);
+    __m256d p = _mm256_set1_pd(P[0]);
+    for (int i = 1; i < 6; ++i) {
+        p = _mm256_add_pd(_mm256_mul_pd(p, z), _mm256_set1_pd(P[i]));
+    }
+    __m256d q = _mm256_add_pd(z, _mm256_set1_pd(Q[0]));
+    for (int i = 1; i < 5; ++i) {
+        q = _mm256_add_pd(_mm256_mul_pd(q, z), _mm256_set1_pd(Q[i]));
+    }
+    const __m256d asin = _mm256_add_pd(a, _mm256_div_pd(_mm256_mul_pd(_mm256_mul_pd(a, z), p), q));
+    return _mm256_add_pd(asin, asin);
+}
+#endif
+
+}  // namespace
+
 double ComputeDistance(Coordinates from, Coordinates to) {
     using namespace std;
     if (from == to) {
         return 0;
     }
-    static const double dr = 3.1415926535 / 180.;
-    static const int earth_radius = 6371000;
-    return acos(sin(from.lat * dr) * sin(to.lat * dr)
-                + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
-        * earth_radius;
+    return acos(sin(from.lat * DR) * sin(to.lat * DR)
+                + cos(from.lat * DR) * cos(to.lat * DR) * cos(abs(from.lng - to.lng) * DR))
+        * EARTH_RADIUS;
+}
+
+void TrigTable::Add(Coordinates coord) {
+    sin_lat_.push_back(std::sin(coord.lat * DR));
+    cos_lat_.push_back(std::cos(coord.lat * DR));
+    sin_lng_.push_back(std::sin(coord.lng * DR));
+    cos_lng_.push_back(std::cos(coord.lng * DR));
+}
+
+void TrigTable::Clear() {
+    sin_lat_.clear();
+    cos_lat_.clear();
+    sin_lng_.clear();
+    cos_lng_.clear();
+}
+
+void TrigTable::Restore(Columns columns) {
+    const size_t size = columns.sin_lat.size();
+    if (columns.cos_lat.size() != size || columns.sin_lng.size() != size || columns.cos_lng.size() != size) {
+        throw std::invalid_argument("Trig table columns differ in size");
+    }
+    sin_lat_ = std::move(columns.sin_lat);
+    cos_lat_ = std::move(columns.cos_lat);
+    sin_lng_ = std::move(columns.sin_lng);
+    cos_lng_ = std::move(columns.cos_lng);
+}
+
+double TrigTable::ComputeDistance(uint32_t from, uint32_t to) const {
+    if (sin_lat_[from] == sin_lat_[to] && cos_lat_[from] == cos_lat_[to]
+        && sin_lng_[from] == sin_lng_[to] && cos_lng_[from] == cos_lng_[to]) {
+        return 0.;
+    }
+    // cos(lng1 - lng2) = cos(lng1) * cos(lng2) + sin(lng1) * sin(lng2).
+    const double cos_angle = sin_lat_[from] * sin_lat_[to]
+        + cos_lat_[from] * cos_lat_[to] * (cos_lng_[from] * cos_lng_[to] + sin_lng_[from] * sin_lng_[to]);
+    return std::acos(std::clamp(cos_angle, -1., 1.)) * EARTH_RADIUS;
+}
+
+double TrigTable::ComputeRouteLength(std::span<const uint32_t> route) const {
+#if defined(GEO_AVX2_KERNEL)
+    if (HasAvx2()) {
+        return ComputeRouteLengthAvx2(route);
+    }
+#endif
+    double length = 0.;
+    for (size_t i = 0; i + 1 < route.size(); ++i) {
+        length += ComputeDistance(route[i], route[i + 1]);
+    }
+    return length;
+}
+
+#if defined(GEO_AVX2_KERNEL)
+GEO_TARGET_AVX2 double TrigTable::ComputeRouteLengthAvx2(std::span<const uint32_t> route) const {
+    double length = 0.;
+    size_t i = 0;
+    // Отрезки [i, i + 1] для четырёх i подряд; блок, где хотя бы один угол
+    // больше 60 градусов, считается скалярно обычным acos.
+    __m256d angles = _mm256_setzero_pd();
+    for (; i + 4 < route.size(); i += 4) {
+        const __m128i from = _mm_loadu_si128(reinterpret_cast<const __m128i*>(route.data() + i));
+        const __m128i to = _mm_loadu_si128(reinterpret_cast<const __m128i*>(route.data() + i + 1));
+        const __m256d sin_lat_from = Gather(sin_lat_.data(), from);
+        const __m256d sin_lat_to = Gather(sin_lat_.data(), to);
+        const __m256d cos_lat_from = Gather(cos_lat_.data(), from);
+        const __m256d cos_lat_to = Gather(cos_lat_.data(), to);
+        const __m256d sin_lng_from = Gather(sin_lng_.data(), from);
+        const __m256d sin_lng_to = Gather(sin_lng_.data(), to);
+        const __m256d cos_lng_from = Gather(cos_lng_.data(), from);
+        const __m256d cos_lng_to = Gather(cos_lng_.data(), to);
+        
+        const __m256d cos_dlng = _mm256_add_pd(_mm256_mul_pd(cos_lng_from, cos_lng_to),
+                                               _mm256_mul_pd(sin_lng_from, sin_lng_to));
+        const __m256d cos_angle = _mm256_min_pd(
+            _mm256_add_pd(_mm256_mul_pd(sin_lat_from, sin_lat_to),
+                          _mm256_mul_pd(_mm256_mul_pd(cos_lat_from, cos_lat_to), cos_dlng)),
+            _mm256_set1_pd(1.));
+        if (_mm256_movemask_pd(_mm256_cmp_pd(cos_angle, _mm256_set1_pd(0.5), _CMP_NGT_UQ)) != 0) {
+            for (size_t k = i; k < i + 4; ++k) {
+                length += ComputeDistance(route[k], route[k + 1]);
+            }
+            continue;
+        }
+        const __m256d same = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(sin_lat_from, sin_lat_to, _CMP_EQ_OQ),
+                          _mm256_cmp_pd(cos_lat_from, cos_lat_to, _CMP_EQ_OQ)),
+            _mm256_and_pd(_mm256_cmp_pd(sin_lng_from, sin_lng_to, _CMP_EQ_OQ),
+                          _mm256_cmp_pd(cos_lng_from, cos_lng_to, _CMP_EQ_OQ)));
+        angles = _mm256_add_pd(angles, _mm256_andnot_pd(same, AcosNearOne(cos_angle)));
+    }
+    alignas(32) double sums[4];
+    _mm256_store_pd(sums, angles);
+    length += (sums[0] + sums[1] + sums[2] + sums[3]) * EARTH_RADIUS;
+    for (; i + 1 < route.size(); ++i) {
+        length += ComputeDistance(route[i], route[i + 1]);
+    }
+    return length;
 }
+#endif
 
-}  // namespace geo
\ No newline at end of file
+}  // namespace geo
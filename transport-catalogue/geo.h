@@ -1,8 +1,15 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
 
 namespace geo{
+
+inline constexpr double DEGREES_TO_RADIANS = 3.1415926535 / 180.;
+inline constexpr double EARTH_RADIUS = 6371000.;
+
 struct Coordinates {
     double lat;
     double lng;
@@ -16,5 +23,56 @@ struct Coordinates {
 
 double ComputeDistance(Coordinates from, Coordinates to);
 
+// Синусы и косинусы широт и долгот точек, посчитанные один раз при
+// добавлении. Расстояния считаются по той же сферической формуле, что и
+// ComputeDistance, но без тригонометрии на каждый отрезок. Косинус угла
+// между точками ограничивается отрезком [-1, 1] (ComputeDistance в этом
+// месте может вернуть NaN), совпадающие точки дают ровно 0. Обе функции
+// отличаются от точного расстояния примерно на R * R * eps / d метров для
+// отрезка длины d: микрометры для километровых отрезков и до 0.2 м для
+// почти совпадающих точек; друг от друга - не больше.
+class TrigTable {
+public:
+    void Add(Coordinates coord);
+    
+    void Clear();
+    
+    size_t GetSize() const {
+        return sin_lat_.size();
+    }
+    
+    // Расстояние между точками с индексами from и to в метрах.
+    double ComputeDistance(uint32_t from, uint32_t to) const;
+    
+    // Длина ломаной, проходящей через точки route, в метрах. Если процессор
+    // поддерживает AVX2, отрезки считаются по четыре за раз.
+    double ComputeRouteLength(std::span<const uint32_t> route) const;
+    
+    // Таблица по столбцам, индекс совпадает с порядком добавления точек.
+    struct Columns {
+        std::vector<double> sin_lat;
+        std::vector<double> cos_lat;
+        std::vector<double> sin_lng;
+        std::vector<double> cos_lng;
+    };
+    
+    Columns GetColumns() const {
+        return {sin_lat_, cos_lat_, sin_lng_, cos_lng_};
+    }
+    
+    // Заменяет таблицу сохранённой через GetColumns. Выбрасывает
+    // std::invalid_argument, если столбцы разной длины.
+    void Restore(Columns columns);
+    
+private:
+    // Вариант для AVX2; определён только на x86-64.
+    double ComputeRouteLengthAvx2(std::span<const uint32_t> route) const;
+    
+    std::vector<double> sin_lat_;
+    std::vector<double> cos_lat_;
+    std::vector<double> sin_lng_;
+    std::vector<double> cos_lng_;
+};
+
     
 }
\ No newline at end of file
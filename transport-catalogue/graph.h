@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+using VertexId = uint32_t;
+using EdgeId = uint32_t;
+
+struct Edge {
+    VertexId from;
+    VertexId to;
+    double weight;
+};
+
+// Ориентированный граф с неотрицательными весами. Рёбра нумеруются подряд
+// с нуля в порядке добавления; кратные рёбра и петли допускаются.
+class DirectedWeightedGraph {
+public:
+    explicit DirectedWeightedGraph(size_t vertex_count = 0)
+        : incidence_lists_(vertex_count) {
+    }
+
+    VertexId AddVertex() {
+        incidence_lists_.emplace_back();
+        return static_cast<VertexId>(incidence_lists_.size() - 1);
+    }
+
+    EdgeId AddEdge(const Edge& edge) {
+        edges_.push_back(edge);
+        const EdgeId id = static_cast<EdgeId>(edges_.size() - 1);
+        incidence_lists_[edge.from].push_back(id);
+        return id;
+    }
+
+    size_t GetVertexCount() const {
+        return incidence_lists_.size();
+    }
+
+    size_t GetEdgeCount() const {
+        return edges_.size();
+    }
+
+    const Edge& GetEdge(EdgeId id) const {
+        return edges_[id];
+    }
+
+    // Рёбра, выходящие из вершины.
+    std::span<const EdgeId> GetIncidentEdges(VertexId vertex) const {
+        return incidence_lists_[vertex];
+    }
+
+private:
+    std::vector<Edge> edges_;
+    std::vector<std::vector<EdgeId>> incidence_lists_;
+};
+
+// Дейкстра от from, ограниченная расстоянием limit: в reached попадают все
+// вершины не дальше limit с расстояниями, в порядке их достижения, начиная с
+// from. for_each_edge(v, relax) вызывает relax(to, weight) для каждого ребра
+// из v. Просматриваются только достижимые в пределах limit вершины; рабочие
+// массивы свои у каждого потока и переиспользуются, поэтому повторные поиски
+// не выделяют память, если reached не растёт.
+template <typename Weight, typename ForEachEdge>
+void FindWithin(size_t vertex_count, VertexId from, Weight limit, ForEachEdge&& for_each_edge,
+                std::vector<std::pair<VertexId, Weight>>& reached) {
+    constexpr Weight UNREACHED = std::numeric_limits<Weight>::max();
+    using QueueItem = std::pair<Weight, VertexId>;
+    struct Scratch {
+        std::vector<Weight> dist;
+        std::vector<VertexId> touched;
+        std::vector<QueueItem> queue;
+    };
+    thread_local Scratch scratch;
+    if (scratch.dist.size() < vertex_count) {
+        scratch.dist.resize(vertex_count, UNREACHED);
+    }
+    reached.clear();
+    if (from >= vertex_count || limit < Weight{}) {
+        return;
+    }
+
+    auto push = [&](VertexId vertex, Weight distance) {
+        if (scratch.dist[vertex] == UNREACHED) {
+            scratch.touched.push_back(vertex);
+        }
+        scratch.dist[vertex] = distance;
+        scratch.queue.emplace_back(distance, vertex);
+        std::push_heap(scratch.queue.begin(), scratch.queue.end(), std::greater<>{});
+    };
+    push(from, Weight{});
+    while (!scratch.queue.empty()) {
+        std::pop_heap(scratch.queue.begin(), scratch.queue.end(), std::greater<>{});
+        const auto [distance, vertex] = scratch.queue.back();
+        scratch.queue.pop_back();
+        if (distance > scratch.dist[vertex]) {
+            continue;
+        }
+        reached.emplace_back(vertex, distance);
+        for_each_edge(vertex, [&](VertexId to, Weight weight) {
+            const Weight candidate = distance + weight;
+            if (candidate <= limit && candidate < scratch.dist[to]) {
+                push(to, candidate);
+            }
+        });
+    }
+    for (VertexId vertex : scratch.touched) {
+        scratch.dist[vertex] = UNREACHED;
+    }
+    scratch.touched.clear();
+}
+
+}  // namespace graph
@@ -1,8 +1,96 @@
 #include "json.h"
 
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <iterator>
+#include <system_error>
+
+// Поиск по 32 байта доступен на любом x86-64 и включается, только если
+// процессор поддерживает AVX2; SSE2 там есть всегда.
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define JSON_AVX2_KERNEL
+#define JSON_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace json {
 
 using namespace std::literals;
+
+Dict::Dict(std::initializer_list<value_type> items)
+    : items_(items) {
+    SortUnique();
+}
+
+Dict::Dict(Items&& items)
+    : items_(std::move(items)) {
+    SortUnique();
+}
+
+void Dict::SortUnique() {
+    const auto less = [](const value_type& lhs, const value_type& rhs) {
+        return lhs.first < rhs.first;
+    };
+    // Словари в запросах короткие: сортировка вставками устойчива и,
+    // в отличие от stable_sort, не берёт временный буфер.
+    if (items_.size() <= 16) {
+        for (auto it = items_.begin(); it != items_.end(); ++it) {
+            std::rotate(std::upper_bound(items_.begin(), it, *it, less), it, std::next(it));
+        }
+    } else {
+        std::stable_sort(items_.begin(), items_.end(), less);
+    }
+    items_.erase(std::unique(items_.begin(), items_.end(), [](const value_type& lhs, const value_type& rhs) {
+        return lhs.first == rhs.first;
+    }), items_.end());
+}
+
+template <typename Iterator>
+Iterator Dict::LowerBound(Iterator first, Iterator last, std::string_view key) {
+    return std::lower_bound(first, last, key, [](const value_type& item, std::string_view k) {
+        return item.first < k;
+    });
+}
+
+Dict::const_iterator Dict::find(std::string_view key) const {
+    const auto it = LowerBound(items_.begin(), items_.end(), key);
+    return it != items_.end() && it->first == key ? it : items_.end();
+}
+
+size_t Dict::count(std::string_view key) const {
+    return find(key) != end() ? 1 : 0;
+}
+
+const Node& Dict::at(std::string_view key) const {
+    const auto it = find(key);
+    if (it == end()) {
+        throw std::out_of_range("Dict key not found"s);
+    }
+    return it->second;
+}
+
+Node& Dict::operator[](std::string_view key) {
+    auto it = LowerBound(items_.begin(), items_.end(), key);
+    if (it == items_.end() || it->first != key) {
+        it = items_.insert(it, {std::string(key), Node{}});
+    }
+    return it->second;
+}
+
+std::pair<Dict::const_iterator, bool> Dict::insert(value_type&& item) {
+    auto it = LowerBound(items_.begin(), items_.end(), item.first);
+    if (it != items_.end() && it->first == item.first) {
+        return {it, false};
+    }
+    return {items_.insert(it, std::move(item)), true};
+}
+
+bool Dict::operator==(const Dict& rhs) const {
+    return items_ == rhs.items_;
+}
     
 bool Node::IsInt() const { 
     return std::holds_alternative<int>(*this); 
@@ -80,88 +168,264 @@ const Dict& Node::AsMap() const {
     return get<Dict>(*this);
 }
     
-Node LoadNode(std::istream& input);
-    
-using Number = std::variant<int, double>;
+namespace {
 
-Node LoadNumber(std::istream& input) {
-    std::string parsed_num;
+#if defined(JSON_AVX2_KERNEL)
+bool HasAvx2() {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
 
-    auto read_char = [&parsed_num, &input] {
-        parsed_num += static_cast<char>(input.get());
-        if (!input) {
-            throw ParsingError("Failed to read number from stream"s);
+// Проверяет [begin, end) блоками по 32 байта. Возвращает первый из символов
+// Chars или nullptr, если в целых блоках их нет; begin тогда указывает на
+// непроверенный хвост короче блока.
+template <char... Chars>
+JSON_TARGET_AVX2 const char* FindAnyOfAvx2(const char*& begin, const char* end) {
+    while (end - begin >= 32) {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        __m256i hits = _mm256_setzero_si256();
+        ((hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(Chars)))), ...);
+        if (const auto mask = static_cast<unsigned>(_mm256_movemask_epi8(hits)); mask != 0) {
+            return begin + std::countr_zero(mask);
         }
-    };
+        begin += 32;
+    }
+    return nullptr;
+}
+#endif
+
+// Возвращает указатель на первый из символов Chars в [begin, end) или end.
+// Блоки без искомых символов проверяются целиком векторными сравнениями.
+template <char... Chars>
+const char* FindAnyOf(const char* begin, const char* end) {
+#if defined(JSON_AVX2_KERNEL)
+    if (HasAvx2()) {
+        if (const char* found = FindAnyOfAvx2<Chars...>(begin, end); found != nullptr) {
+            return found;
+        }
+    }
+#endif
+#if defined(__SSE2__)
+    while (end - begin >= 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        __m128i hits = _mm_setzero_si128();
+        ((hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(Chars)))), ...);
+        if (const auto mask = static_cast<unsigned>(_mm_movemask_epi8(hits)); mask != 0) {
+            return begin + std::countr_zero(mask);
+        }
+        begin += 16;
+    }
+#endif
+    while (begin != end && ((*begin != Chars) && ...)) {
+        ++begin;
+    }
+    return begin;
+}
+
+// Разбирает JSON из непрерывного буфера сырыми указателями и сообщает о
+// прочитанных элементах обработчику. Поток, если он задан, дочитывается в
+// буфер блоками по мере продвижения разбора.
+class Parser {
+public:
+    Parser(std::istream& input, Handler& handler)
+        : handler_(handler)
+        , input_(input.rdbuf())
+        , buffer_(BUFFER_SIZE) {
+    }
+
+    Parser(std::string_view text, Handler& handler)
+        : handler_(handler)
+        , cur_(text.data())
+        , end_(text.data() + text.size()) {
+    }
+
+    void LoadNode();
+
+private:
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+    bool Fill();
+    int Peek();
+    char Get();
+    char GetSignificant();
+    void SkipSpaces();
+    void ReadWord(std::string_view word, const char* error);
+
+    void LoadNumber();
+    const char* ConvertNumber(const char* begin, const char* end);
+    std::string LoadString();
+    void LoadArray();
+    void LoadNull();
+    void LoadBool();
+    void LoadDict();
 
-    auto read_digits = [&input, read_char] {
-        if (!std::isdigit(input.peek())) {
+    Handler& handler_;
+    std::streambuf* input_ = nullptr;
+    std::vector<char> buffer_;
+    const char* cur_ = nullptr;
+    const char* end_ = nullptr;
+};
+
+bool Parser::Fill() {
+    if (cur_ != end_) {
+        return true;
+    }
+    if (input_ == nullptr) {
+        return false;
+    }
+    const std::streamsize count = input_->sgetn(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    if (count <= 0) {
+        return false;
+    }
+    cur_ = buffer_.data();
+    end_ = cur_ + count;
+    return true;
+}
+
+int Parser::Peek() {
+    return Fill() ? static_cast<unsigned char>(*cur_) : EOF;
+}
+
+char Parser::Get() {
+    if (!Fill()) {
+        throw ParsingError("Unexpected end of input"s);
+    }
+    return *cur_++;
+}
+
+void Parser::SkipSpaces() {
+    while (Fill() && std::isspace(static_cast<unsigned char>(*cur_))) {
+        ++cur_;
+    }
+}
+
+char Parser::GetSignificant() {
+    SkipSpaces();
+    return Get();
+}
+
+void Parser::ReadWord(std::string_view word, const char* error) {
+    for (char expected : word) {
+        if (Peek() != static_cast<unsigned char>(expected)) {
+            throw ParsingError(error);
+        }
+        ++cur_;
+    }
+    if (std::isalpha(Peek())) {
+        throw ParsingError(error);
+    }
+}
+
+bool IsNumberChar(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+bool IsDigit(const char* pos, const char* end) {
+    return pos != end && *pos >= '0' && *pos <= '9';
+}
+
+// Проверяет грамматику числа JSON, начинающегося в begin, и возвращает
+// указатель на его конец. is_int сообщает, есть ли дробная часть или порядок.
+const char* ScanNumber(const char* begin, const char* end, bool& is_int) {
+    const char* pos = begin;
+
+    auto read_digits = [&pos, end] {
+        if (!IsDigit(pos, end)) {
             throw ParsingError("A digit is expected"s);
         }
-        while (std::isdigit(input.peek())) {
-            read_char();
+        while (IsDigit(pos, end)) {
+            ++pos;
         }
     };
 
-    if (input.peek() == '-') {
-        read_char();
+    if (pos != end && *pos == '-') {
+        ++pos;
     }
 
-    if (input.peek() == '0') {
-        read_char();
+    if (pos != end && *pos == '0') {
+        ++pos;
     } else {
         read_digits();
     }
 
-    bool is_int = true;
+    is_int = true;
 
-    if (input.peek() == '.') {
-        read_char();
+    if (pos != end && *pos == '.') {
+        ++pos;
         read_digits();
         is_int = false;
     }
 
-    if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-        read_char();
-        if (ch = input.peek(); ch == '+' || ch == '-') {
-            read_char();
+    if (pos != end && (*pos == 'e' || *pos == 'E')) {
+        ++pos;
+        if (pos != end && (*pos == '+' || *pos == '-')) {
+            ++pos;
         }
         read_digits();
         is_int = false;
     }
+    return pos;
+}
 
-    try {
-        if (is_int) {
-            try {
-                return Node(std::stoi(parsed_num));
-            } catch (...) {
-            }
+void Parser::LoadNumber() {
+    const char* token_end = cur_;
+    while (token_end != end_ && IsNumberChar(*token_end)) {
+        ++token_end;
+    }
+    if (token_end == end_ && input_ != nullptr) {
+        // Число может продолжаться в следующем блоке потока.
+        std::string parsed_num;
+        while (Fill() && IsNumberChar(*cur_)) {
+            parsed_num += *cur_++;
+        }
+        const char* begin = parsed_num.data();
+        const char* end = begin + parsed_num.size();
+        if (ConvertNumber(begin, end) != end) {
+            throw ParsingError("Failed to read number from stream"s);
         }
-        return Node(std::stod(parsed_num));
-    } catch (...) {
-        throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
+        return;
     }
+    cur_ = ConvertNumber(cur_, token_end);
 }
 
-Node LoadString(std::istream& input) {
-    
-    auto it = std::istreambuf_iterator<char>(input);
-    auto end = std::istreambuf_iterator<char>();
+const char* Parser::ConvertNumber(const char* begin, const char* end) {
+    bool is_int = true;
+    end = ScanNumber(begin, end, is_int);
+    if (is_int) {
+        int value = 0;
+        if (std::from_chars(begin, end, value).ec == std::errc{}) {
+            handler_.Int(value);
+            return end;
+        }
+    }
+    double value = 0.;
+    if (std::from_chars(begin, end, value).ec != std::errc{}) {
+        throw ParsingError("Failed to convert "s + std::string(begin, end) + " to number"s);
+    }
+    handler_.Double(value);
+    return end;
+}
+
+std::string Parser::LoadString() {
     std::string s;
     while (true) {
-        if (it == end) {
+        if (!Fill()) {
             throw ParsingError("String parsing error");
         }
-        const char ch = *it;
+        const char* run = cur_;
+        cur_ = FindAnyOf<'"', '\\', '\n', '\r'>(cur_, end_);
+        s.append(run, cur_);
+        if (cur_ == end_) {
+            continue;
+        }
+        const char ch = *cur_++;
         if (ch == '"') {
-            ++it;
             break;
         } else if (ch == '\\') {
-            ++it;
-            if (it == end) {
+            if (!Fill()) {
                 throw ParsingError("String parsing error");
             }
-            const char escaped_char = *(it);
+            const char escaped_char = *cur_++;
             switch (escaped_char) {
                 case 'n':
                     s.push_back('\n');
@@ -181,105 +445,96 @@ Node LoadString(std::istream& input) {
                 default:
                     throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
             }
-        } else if (ch == '\n' || ch == '\r') {
-            throw ParsingError("Unexpected end of line"s);
         } else {
-            s.push_back(ch);
+            throw ParsingError("Unexpected end of line"s);
         }
-        ++it;
     }
     return s;
 }
 
-Node LoadArray(std::istream& input) {
-    Array result;
-    if (input.peek() == -1) {
-        throw ParsingError("Array parsing error");
+void Parser::LoadArray() {
+    handler_.StartArray();
+    SkipSpaces();
+    if (Peek() == ']') {
+        ++cur_;
+        handler_.EndArray();
+        return;
     }
-    for (char c; input >> c && c != ']';) {
+    while (true) {
+        LoadNode();
+        const char c = GetSignificant();
+        if (c == ']') {
+            break;
+        }
         if (c != ',') {
-            input.putback(c);
+            throw ParsingError("Array parsing error");
         }
-        result.push_back(LoadNode(input));
     }
-    return Node(move(result));
+    handler_.EndArray();
 }
-    
-Node LoadNull(std::istream& input) {
-    static const std::string nameNull = "null";
-    for (size_t i = 0; i < nameNull.size(); i++) {
-        if (nameNull.at(i) == input.peek()){
-            input.get();
-        }
-        else {
-            throw ParsingError("Null parsing error");
-        }
-    }
-    if (std::isalpha(input.peek())){
-        throw ParsingError("Null parsing error");
-    }
-    return {};
+
+void Parser::LoadNull() {
+    ReadWord("null"sv, "Null parsing error");
+    handler_.Null();
 }
-    
-Node LoadBool(std::istream& input) {
-    static const std::string nameFalse = "false"s;
-    static const std::string nameTrue = "true"s;
-    char c = input.get();
-    bool value = (c == 't');
-    std::string name = value ? nameTrue : nameFalse;
-    for (size_t i = 1; i < name.size(); i++) {
-        if (name[i] == input.peek()){
-            input.get();
-        }
-        else throw ParsingError("Bool parsing error");
-    }
-    if (std::isalpha(input.peek())){
-        throw ParsingError("Bool parsing error");
-    }
-    return Node(value);
+
+void Parser::LoadBool() {
+    const bool value = (Peek() == 't');
+    ReadWord(value ? "true"sv : "false"sv, "Bool parsing error");
+    handler_.Bool(value);
 }
 
-Node LoadDict(std::istream& input) {
-    Dict result;
-    if (input.peek() == -1) throw ParsingError("Dict parsing error");
-    for (char c; input >> c && c != '}';) {
-        if (c == ',') {
-            input >> c;
+void Parser::LoadDict() {
+    handler_.StartDict();
+    SkipSpaces();
+    if (Peek() == '}') {
+        ++cur_;
+        handler_.EndDict();
+        return;
+    }
+    while (true) {
+        if (GetSignificant() != '"') {
+            throw ParsingError("Dict parsing error");
+        }
+        handler_.Key(LoadString());
+        if (GetSignificant() != ':') {
+            throw ParsingError("Dict parsing error");
+        }
+        LoadNode();
+        const char c = GetSignificant();
+        if (c == '}') {
+            break;
+        }
+        if (c != ',') {
+            throw ParsingError("Dict parsing error");
         }
-        std::string key = LoadString(input).AsString();
-        input >> c;
-        result.insert({move(key), LoadNode(input)});
     }
-
-    return Node(move(result));
+    handler_.EndDict();
 }
 
-Node LoadNode(std::istream& input) {
-    char c;
-    input >> c;
+void Parser::LoadNode() {
+    SkipSpaces();
+    const int c = Peek();
     if (c == 'n') {
-        input.putback(c);
-        return LoadNull(input);
-    }
-    else if (c == '"') {
-        return LoadString(input);
-    }
-    else if (c == 't' || c == 'f') {
-        input.putback(c);
-        return LoadBool(input);
-    }
-    else if (c == '[') {
-        return LoadArray(input);
-    }
-    else if (c == '{') {
-        return LoadDict(input);
+        LoadNull();
+    } else if (c == '"') {
+        ++cur_;
+        handler_.String(LoadString());
+    } else if (c == 't' || c == 'f') {
+        LoadBool();
+    } else if (c == '[') {
+        ++cur_;
+        LoadArray();
+    } else if (c == '{') {
+        ++cur_;
+        LoadDict();
+    } else {
+        LoadNumber();
     }
-    else {
-        input.putback(c);
-        return LoadNumber(input);
-    } 
 }
 
+}  // namespace
+
 Document::Document(Node root)
     : root_(std::move(root)) {
 }
@@ -288,16 +543,120 @@ const Node& Document::GetRoot() const {
     return root_;
 }
 
+void DomBuilder::Null() {
+    AddValue(Node{});
+}
+
+void DomBuilder::Bool(bool value) {
+    AddValue(Node{value});
+}
+
+void DomBuilder::Int(int value) {
+    AddValue(Node{value});
+}
+
+void DomBuilder::Double(double value) {
+    AddValue(Node{value});
+}
+
+void DomBuilder::String(std::string&& value) {
+    AddValue(Node{std::move(value)});
+}
+
+void DomBuilder::StartDict() {
+    stack_.emplace_back(TakeBuffer(free_items_));
+}
+
+void DomBuilder::Key(std::string&& key) {
+    keys_.push_back(std::move(key));
+}
+
+void DomBuilder::EndDict() {
+    Node node{Dict{ReleaseBuffer(std::get<Dict::Items>(stack_.back()), free_items_)}};
+    stack_.pop_back();
+    AddValue(std::move(node));
+}
+
+void DomBuilder::StartArray() {
+    stack_.emplace_back(TakeBuffer(free_arrays_));
+}
+
+void DomBuilder::EndArray() {
+    Node node{ReleaseBuffer(std::get<Array>(stack_.back()), free_arrays_)};
+    stack_.pop_back();
+    AddValue(std::move(node));
+}
+
+Node DomBuilder::Extract() {
+    Node result = std::move(root_);
+    root_ = Node{};
+    is_complete_ = false;
+    return result;
+}
+
+template <typename Container>
+Container DomBuilder::TakeBuffer(std::vector<Container>& free_buffers) {
+    if (free_buffers.empty()) {
+        return {};
+    }
+    Container buffer = std::move(free_buffers.back());
+    free_buffers.pop_back();
+    return buffer;
+}
+
+template <typename Container>
+Container DomBuilder::ReleaseBuffer(Container& buffer, std::vector<Container>& free_buffers) {
+    // Узел получает копию точного размера, а буфер с его ёмкостью
+    // достаётся следующему контейнеру той же глубины.
+    Container result(std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+    buffer.clear();
+    free_buffers.push_back(std::move(buffer));
+    return result;
+}
+
+void DomBuilder::AddValue(Node&& value) {
+    if (stack_.empty()) {
+        root_ = std::move(value);
+        is_complete_ = true;
+    } else if (auto* array = std::get_if<Array>(&stack_.back())) {
+        array->push_back(std::move(value));
+    } else {
+        std::get<Dict::Items>(stack_.back()).emplace_back(std::move(keys_.back()), std::move(value));
+        keys_.pop_back();
+    }
+}
+
+void Parse(std::istream& input, Handler& handler) {
+    Parser(input, handler).LoadNode();
+}
+
+void Parse(std::string_view text, Handler& handler) {
+    Parser(text, handler).LoadNode();
+}
+
 Document Load(std::istream& input) {
-    return Document{LoadNode(input)};
+    DomBuilder builder;
+    Parse(input, builder);
+    return Document{builder.Extract()};
+}
+
+Document Load(std::string_view text) {
+    DomBuilder builder;
+    Parse(text, builder);
+    return Document{builder.Extract()};
 }
 
 void PrintValue(std::ostream& out, int value) {
-    out << value;
+    char buffer[16];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.write(buffer, result.ptr - buffer);
 }
     
 void PrintValue(std::ostream& out, double value) {
-    out << value;
+    // Кратчайшая запись, по которой число восстанавливается без потерь.
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.write(buffer, result.ptr - buffer);
 }
     
 void PrintValue(std::ostream& out, std::nullptr_t) {
@@ -308,10 +667,19 @@ void PrintValue(std::ostream& out, bool value) {
     out << std::boolalpha << value;
 }
     
-void PrintValue(std::ostream& out, const std::string& str) {
-    out << "\""sv;
-    for ( char c: str) {
-        switch (c){
+namespace {
+
+void PrintString(std::ostream& out, std::string_view str) {
+    out.put('"');
+    const char* pos = str.data();
+    const char* const end = pos + str.size();
+    while (pos != end) {
+        const char* special = FindAnyOf<'\\', '"', '\n', '\r', '\t'>(pos, end);
+        out.write(pos, special - pos);
+        if (special == end) {
+            break;
+        }
+        switch (*special){
             case'\\': 
                 out << "\\\\"sv;
                 break;
@@ -327,12 +695,16 @@ void PrintValue(std::ostream& out, const std::string& str) {
             case'\t':
                 out << "\\t"sv;
                 break;
-            default:
-                out << c;
-                break;
         }
+        pos = special + 1;
     }
-    out << "\""sv;
+    out.put('"');
+}
+
+}  // namespace
+    
+void PrintValue(std::ostream& out, const std::string& str) {
+    PrintString(out, str);
 }
     
 void PrintValue(std::ostream& out, const Array& arr) {
@@ -373,4 +745,101 @@ void Print(const Document& doc, std::ostream& output) {
     PrintNode(output, doc.GetRoot());
 }
 
+Writer& Writer::StartArray() {
+    BeforeValue();
+    out_.put('[');
+    is_first_.push_back(true);
+    return *this;
+}
+
+Writer& Writer::EndArray() {
+    is_first_.pop_back();
+    out_.put(']');
+    return *this;
+}
+
+Writer& Writer::StartDict() {
+    BeforeValue();
+    out_.put('{');
+    is_first_.push_back(true);
+    return *this;
+}
+
+Writer& Writer::EndDict() {
+    is_first_.pop_back();
+    out_.put('}');
+    return *this;
+}
+
+Writer& Writer::Key(std::string_view key) {
+    BeforeValue();
+    PrintString(out_, key);
+    out_.put(':');
+    after_key_ = true;
+    return *this;
+}
+
+Writer& Writer::Value(std::nullptr_t) {
+    BeforeValue();
+    PrintValue(out_, nullptr);
+    return *this;
+}
+
+Writer& Writer::Value(bool value) {
+    BeforeValue();
+    PrintValue(out_, value);
+    return *this;
+}
+
+Writer& Writer::Value(int value) {
+    BeforeValue();
+    PrintValue(out_, value);
+    return *this;
+}
+
+Writer& Writer::Value(double value) {
+    BeforeValue();
+    PrintValue(out_, value);
+    return *this;
+}
+
+Writer& Writer::Value(std::string_view value) {
+    BeforeValue();
+    PrintString(out_, value);
+    return *this;
+}
+
+Writer& Writer::Value(const std::string& value) {
+    return Value(std::string_view(value));
+}
+
+Writer& Writer::Value(const char* value) {
+    return Value(std::string_view(value));
+}
+
+Writer& Writer::Value(const Node& value) {
+    BeforeValue();
+    PrintNode(out_, value);
+    return *this;
+}
+
+Writer& Writer::RawValue(std::string_view json) {
+    BeforeValue();
+    out_.write(json.data(), static_cast<std::streamsize>(json.size()));
+    return *this;
+}
+
+void Writer::BeforeValue() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (!is_first_.empty()) {
+        if (!is_first_.back()) {
+            out_.put(',');
+        }
+        is_first_.back() = false;
+    }
+}
+
 }
\ No newline at end of file
@@ -4,9 +4,12 @@
 #include <cctype>
 #include <iostream>
 #include <iomanip>
-#include <map>
+#include <initializer_list>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -15,7 +18,41 @@ namespace json {
 
 class Node;
 
-using Dict = std::map<std::string, Node>;
+// Словарь JSON. Пары хранятся в одном непрерывном массиве, упорядоченном по
+// ключу, поэтому объект запроса занимает одну аллокацию вместо узла на ключ.
+// Интерфейс повторяет нужную часть std::map.
+class Dict {
+public:
+    using value_type = std::pair<std::string, Node>;
+    using Items = std::vector<value_type>;
+    using const_iterator = Items::const_iterator;
+
+    Dict() = default;
+    Dict(std::initializer_list<value_type> items);
+    // Пары могут идти в любом порядке; из повторяющихся ключей остаётся первый.
+    explicit Dict(Items&& items);
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    size_t size() const;
+    bool empty() const;
+
+    const_iterator find(std::string_view key) const;
+    size_t count(std::string_view key) const;
+    const Node& at(std::string_view key) const;
+    Node& operator[](std::string_view key);
+    std::pair<const_iterator, bool> insert(value_type&& item);
+
+    bool operator==(const Dict& rhs) const;
+
+private:
+    template <typename Iterator>
+    static Iterator LowerBound(Iterator first, Iterator last, std::string_view key);
+    void SortUnique();
+
+    Items items_;
+};
+
 using Array = std::vector<Node>;
 using Value = std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string>;
 
@@ -54,6 +91,22 @@ public:
         return !(*this == rhs);
     }
 };
+
+inline Dict::const_iterator Dict::begin() const {
+    return items_.begin();
+}
+
+inline Dict::const_iterator Dict::end() const {
+    return items_.end();
+}
+
+inline size_t Dict::size() const {
+    return items_.size();
+}
+
+inline bool Dict::empty() const {
+    return items_.empty();
+}
     
 void PrintValue(std::ostream& out, std::nullptr_t);
 void PrintValue(std::ostream& out, bool value);
@@ -82,8 +135,100 @@ private:
     Node root_;
 };
 
+// Получает события разбора по мере чтения входных данных, не дожидаясь
+// построения дерева документа.
+class Handler {
+public:
+    virtual void Null() = 0;
+    virtual void Bool(bool value) = 0;
+    virtual void Int(int value) = 0;
+    virtual void Double(double value) = 0;
+    virtual void String(std::string&& value) = 0;
+    virtual void StartDict() = 0;
+    virtual void Key(std::string&& key) = 0;
+    virtual void EndDict() = 0;
+    virtual void StartArray() = 0;
+    virtual void EndArray() = 0;
+
+protected:
+    ~Handler() = default;
+};
+
+// Собирает из событий разбора одно значение вместе со всеми вложенными.
+class DomBuilder final : public Handler {
+public:
+    void Null() override;
+    void Bool(bool value) override;
+    void Int(int value) override;
+    void Double(double value) override;
+    void String(std::string&& value) override;
+    void StartDict() override;
+    void Key(std::string&& key) override;
+    void EndDict() override;
+    void StartArray() override;
+    void EndArray() override;
+
+    bool IsComplete() const {
+        return is_complete_;
+    }
+
+    Node Extract();
+
+private:
+    template <typename Container>
+    static Container TakeBuffer(std::vector<Container>& free_buffers);
+    template <typename Container>
+    static Container ReleaseBuffer(Container& buffer, std::vector<Container>& free_buffers);
+    void AddValue(Node&& value);
+
+    std::vector<std::variant<Array, Dict::Items>> stack_;
+    // Освободившиеся буферы контейнеров с сохранённой ёмкостью.
+    std::vector<Array> free_arrays_;
+    std::vector<Dict::Items> free_items_;
+    std::vector<std::string> keys_;
+    Node root_;
+    bool is_complete_ = false;
+};
+
+void Parse(std::istream& input, Handler& handler);
+void Parse(std::string_view text, Handler& handler);
+
 Document Load(std::istream& input);
+Document Load(std::string_view text);
 
 void Print(const Document& doc, std::ostream& output);
 
+// Пишет JSON прямо в поток по мере поступления значений, не собирая дерево.
+// Запятые и двоеточия расставляются автоматически.
+class Writer {
+public:
+    explicit Writer(std::ostream& out)
+        : out_(out) {
+    }
+
+    Writer& StartArray();
+    Writer& EndArray();
+    Writer& StartDict();
+    Writer& EndDict();
+    Writer& Key(std::string_view key);
+
+    Writer& Value(std::nullptr_t);
+    Writer& Value(bool value);
+    Writer& Value(int value);
+    Writer& Value(double value);
+    Writer& Value(std::string_view value);
+    Writer& Value(const std::string& value);
+    Writer& Value(const char* value);
+    Writer& Value(const Node& value);
+    // Вставляет очередным значением уже сериализованный JSON.
+    Writer& RawValue(std::string_view json);
+
+private:
+    void BeforeValue();
+
+    std::ostream& out_;
+    std::vector<bool> is_first_;
+    bool after_key_ = false;
+};
+
 }
\ No newline at end of file
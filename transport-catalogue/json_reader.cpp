@@ -3,139 +3,696 @@
 #include <algorithm>
 #include <cassert>
 #include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <span>
+#include <sstream>
 
 
 namespace json_reader{
     
-    std::vector<std::string_view> JSONReader::ParseRoute(const json::Array& stops, bool is_roundtrip){
-        std::vector<std::string_view> results;
-        for(auto& stop_node: stops){
-            std::string_view stop = stop_node.AsString();;
-            results.push_back(stop);
+namespace {
+    
+// Сколько запросов может одновременно находиться между разбором и выводом.
+constexpr size_t STAT_PIPELINE_CAPACITY = 1024;
+
+// Пишет достигнутые остановки по возрастанию значения, при равенстве - по названию.
+template <typename Value>
+void WriteReachedStops(const transport_catalogue::TransportCatalogue& catalogue,
+                       std::vector<std::pair<transport_catalogue::StopId, Value>>& reached,
+                       std::string_view value_key, json::Writer& writer){
+    std::sort(reached.begin(), reached.end(), [&catalogue](const auto& lhs, const auto& rhs){
+        return lhs.second < rhs.second
+            || (lhs.second == rhs.second && catalogue.GetStop(lhs.first).name < catalogue.GetStop(rhs.first).name);
+    });
+    writer.Key("stops"sv).StartArray();
+    // Ключи, как и во всех ответах, по алфавиту.
+    const bool is_value_first = value_key < "name"sv;
+    for(const auto& [id, value]:reached){
+        writer.StartDict();
+        if(is_value_first){
+            writer.Key(value_key).Value(value);
         }
-        if(!is_roundtrip){
-            results.insert(results.end(), std::next(results.rbegin()), results.rend());
+        writer.Key("name"sv).Value(catalogue.GetStop(id).name);
+        if(!is_value_first){
+            writer.Key(value_key).Value(value);
         }
-        return results;
+        writer.EndDict();
+    }
+    writer.EndArray();
+}
+
+// Ответ на запрос, которому для выполнения не хватает данных.
+void WriteError(const json::Dict& request, std::string_view message, json::Writer& writer){
+    writer.StartDict()
+          .Key("error_message"sv).Value(message)
+          .Key("request_id"sv).Value(request.at("id"s))
+          .EndDict();
+}
+
+// Отвечает на stat_requests по мере их разбора. Запросы начинают выполняться,
+// как только загружен справочник и известны render_settings; пришедшие раньше
+// копятся и отправляются вместе с первым готовым. Запросам маршрутизации нужен
+// ещё и раздел routing_settings: такой запрос и все следующие за ним, чтобы
+// сохранить порядок ответов, ждут его или конца документа.
+class StatRequestsPipeline {
+public:
+    StatRequestsPipeline(JSONReader& reader, std::ostream& output)
+        : reader_(reader), writer_(output) {
     }
     
-    void JSONReader::BaseRequests(json::Array& base_requests){
-        std::vector<size_t> buses;
-        std::vector< std::pair<std::string, json::Dict>> from_stop_to_stop_distance;
-        for(size_t i = 0; i !=base_requests.size(); ++i){
-            json::Dict request = base_requests[i].AsMap();
-            if (request["type"s].AsString() == "Stop"s){
-                std::string name = request["name"s].AsString(); 
-                if(auto road_distances (request["road_distances"s].AsMap()); !road_distances.empty()){
-                    from_stop_to_stop_distance.push_back({name, road_distances});
-                }
-                catalogue_.AddStop(std::move(name), {request["latitude"s].AsDouble(), request["longitude"s].AsDouble()});
-            } else{
-                buses.push_back(i);
+    void SetBaseReady() {
+        is_base_ready_ = true;
+        TryStart();
+    }
+    
+    void SetRenderSettings(const json::Dict& render_settings) {
+        mapping_ = map_renderer::RenderSettings(render_settings);
+        TryStart();
+    }
+    
+    void SetRoutingSettings(const json::Dict& routing_settings) {
+        routing_settings_ = transport_router::GetRoutingSettings(routing_settings);
+        TryStart();
+        PushPending();
+    }
+    
+    void StartRequests() {
+        has_requests_ = true;
+    }
+    
+    void AddRequest(json::Node request) {
+        pending_.push_back(std::move(request));
+        PushPending();
+    }
+    
+    // Вызывается в конце документа: выполняет отложенные запросы и дожидается вывода.
+    void Finish() {
+        if (!has_requests_) {
+            throw std::out_of_range("stat_requests are missing"s);
+        }
+        if (!mapping_) {
+            throw std::out_of_range("render_settings are missing"s);
+        }
+        is_base_ready_ = true;
+        is_finished_ = true;
+        TryStart();
+        PushPending();
+        pipeline_->Finish();
+        writer_.EndArray();
+    }
+    
+private:
+    void TryStart() {
+        if (!is_base_ready_) {
+            return;
+        }
+        // Маршрутизатор строится здесь, пока запросы, которым он нужен, ещё не
+        // переданы в pipeline; остальные в это время уже выполняются.
+        if (routing_settings_ && !is_router_ready_) {
+            reader_.SetRoutingSettings(*routing_settings_);
+            is_router_ready_ = true;
+        }
+        if (pipeline_ || !mapping_) {
+            return;
+        }
+        writer_.StartArray();
+        pipeline_.emplace(reader_.GetExecutor().GetThreadCount(), STAT_PIPELINE_CAPACITY,
+                          [this](json::Node& request) {
+                              return reader_.StatRequest(request.AsMap(), *mapping_);
+                          },
+                          [this](const std::string& answer) {
+                              writer_.RawValue(answer);
+                          });
+        PushPending();
+    }
+    
+    // Передаёт отложенные запросы по порядку до первого, которому нужен ещё не
+    // построенный маршрутизатор. В конце документа ждать больше нечего: такие
+    // запросы получат ответ об отсутствии routing_settings.
+    void PushPending() {
+        if (!pipeline_) {
+            return;
+        }
+        while (pending_first_ < pending_.size()) {
+            json::Node& request = pending_[pending_first_];
+            if (!is_router_ready_ && !is_finished_ && NeedsRouter(request.AsMap())) {
+                return;
             }
+            pipeline_->Push(std::move(request));
+            ++pending_first_;
         }
-        
-        for (const auto& [from, all_to_and_distance] : from_stop_to_stop_distance) {
-            for (const auto& [to, distance] : all_to_and_distance){
-                catalogue_.AddDistanceStops(from, to, distance.AsInt());
+        pending_.clear();
+        pending_first_ = 0;
+    }
+    
+    static bool NeedsRouter(const json::Dict& request) {
+        const std::string& type = request.at("type"s).AsString();
+        return type == "Route"sv || type == "DistanceMatrix"sv
+            || (type == "Reachable"sv && request.count("max_time"s) > 0);
+    }
+    
+    JSONReader& reader_;
+    json::Writer writer_;
+    std::optional<map_renderer::Mapping> mapping_;
+    std::optional<transport_router::RoutingSettings> routing_settings_;
+    bool is_base_ready_ = false;
+    bool is_router_ready_ = false;
+    bool is_finished_ = false;
+    bool has_requests_ = false;
+    // Ожидающие запросы - pending_ начиная с pending_first_.
+    std::vector<json::Node> pending_;
+    size_t pending_first_ = 0;
+    std::optional<request_handler::OrderedPipeline<json::Node>> pipeline_;
+};
+    
+// Разбирает корневой словарь запроса: base_requests сразу загружается в
+// справочник, остальные разделы собираются в дерево. Если задан pipeline,
+// элементы stat_requests не копятся, а по одному передаются в него.
+class RequestsHandler final : public json::Handler {
+public:
+    explicit RequestsHandler(transport_catalogue::TransportCatalogue& catalogue,
+                             StatRequestsPipeline* pipeline = nullptr)
+        : base_requests_(catalogue), pipeline_(pipeline) {
+    }
+    
+    void Null() override {
+        Target().Null();
+        FinishValue();
+    }
+    
+    void Bool(bool value) override {
+        Target().Bool(value);
+        FinishValue();
+    }
+    
+    void Int(int value) override {
+        Target().Int(value);
+        FinishValue();
+    }
+    
+    void Double(double value) override {
+        Target().Double(value);
+        FinishValue();
+    }
+    
+    void String(std::string&& value) override {
+        Target().String(std::move(value));
+        FinishValue();
+    }
+    
+    void StartDict() override {
+        if (depth_++ != 0) {
+            Target().StartDict();
+        }
+    }
+    
+    void Key(std::string&& key) override {
+        if (depth_ == 1) {
+            section_ = std::move(key);
+            target_ = section_ == "base_requests"s ? static_cast<json::Handler*>(&base_requests_) : &builder_;
+            is_streaming_ = pipeline_ != nullptr && section_ == "stat_requests"s;
+        } else {
+            Target().Key(std::move(key));
+        }
+    }
+    
+    void EndDict() override {
+        if (--depth_ != 0) {
+            Target().EndDict();
+            FinishValue();
+        }
+    }
+    
+    void StartArray() override {
+        if (is_streaming_ && depth_ == 1) {
+            ++depth_;
+            pipeline_->StartRequests();
+            return;
+        }
+        ++depth_;
+        Target().StartArray();
+    }
+    
+    void EndArray() override {
+        if (is_streaming_ && depth_ == 2) {
+            --depth_;
+            is_streaming_ = false;
+            return;
+        }
+        --depth_;
+        Target().EndArray();
+        FinishValue();
+    }
+    
+    json::Dict ExtractSections() {
+        return std::move(sections_);
+    }
+    
+private:
+    json::Handler& Target() {
+        if (target_ == nullptr) {
+            throw json::ParsingError("Requests must be a dict"s);
+        }
+        return *target_;
+    }
+    
+    void FinishValue() {
+        if (is_streaming_) {
+            if (depth_ == 2) {
+                pipeline_->AddRequest(builder_.Extract());
             }
+            return;
         }
-        
-        for (size_t i : buses){
-            json::Dict request = base_requests[i].AsMap();
-            std::string name = request["name"s].AsString();
-            catalogue_.AddBus(std::move(name), ParseRoute(request["stops"s].AsArray(), request["is_roundtrip"s].AsBool()));
+        if (depth_ != 1) {
+            return;
+        }
+        if (target_ == &base_requests_) {
+            if (pipeline_ != nullptr) {
+                pipeline_->SetBaseReady();
+            }
+            return;
+        }
+        const auto [section, is_inserted] = sections_.insert({std::move(section_), builder_.Extract()});
+        if (pipeline_ != nullptr && is_inserted && section->first == "render_settings"sv) {
+            pipeline_->SetRenderSettings(section->second.AsMap());
+        } else if (pipeline_ != nullptr && is_inserted && section->first == "routing_settings"sv) {
+            pipeline_->SetRoutingSettings(section->second.AsMap());
         }
     }
-
-    bool CompareSortBus(const transport_catalogue::Bus* lhs, const transport_catalogue::Bus* rhs){
-        return (*lhs).name < (*rhs).name;
+    
+    BaseRequestsHandler base_requests_;
+    StatRequestsPipeline* pipeline_;
+    json::DomBuilder builder_;
+    bool is_streaming_ = false;
+    json::Handler* target_ = nullptr;
+    std::string section_;
+    json::Dict sections_;
+    int depth_ = 0;
+};
+    
+}  // namespace
+    
+    void BaseRequestsHandler::Null() {
     }
     
-    double JSONReader::CalculateGeographyLength(const std::vector<const transport_catalogue::Stop*>& stops){
-        double length = 0;
-        for(size_t i = 0; i+1!= stops.size();++i){
-            length +=ComputeDistance((*(stops[i])).coord, (*(stops[i+1])).coord);
+    void BaseRequestsHandler::Bool(bool value) {
+        if (depth_ == 2 && field_ == Field::IS_ROUNDTRIP) {
+            request_.is_roundtrip = value;
         }
-        return length;
     }
-
-    int JSONReader::CalculateRouteLength(const std::vector<const transport_catalogue::Stop*>& stops) {
-        int length = 0;
-        for (size_t i = 0; i+1 != stops.size(); ++i) {
-            length += catalogue_.GetDistanceStops((*(stops[i])).name, (*(stops[i + 1])).name);
+    
+    void BaseRequestsHandler::Int(int value) {
+        if (depth_ == 3 && field_ == Field::ROAD_DISTANCES) {
+            request_.road_distances.push_back({std::move(distance_to_), value});
+        } else {
+            SetNumber(value);
+        }
+    }
+    
+    void BaseRequestsHandler::Double(double value) {
+        SetNumber(value);
+    }
+    
+    void BaseRequestsHandler::SetNumber(double value) {
+        if (depth_ != 2) {
+            return;
+        }
+        if (field_ == Field::LATITUDE) {
+            request_.coord.lat = value;
+        } else if (field_ == Field::LONGITUDE) {
+            request_.coord.lng = value;
+        }
+    }
+    
+    void BaseRequestsHandler::String(std::string&& value) {
+        if (depth_ == 2 && field_ == Field::TYPE) {
+            request_.type = std::move(value);
+        } else if (depth_ == 2 && field_ == Field::NAME) {
+            request_.name = std::move(value);
+        } else if (depth_ == 3 && field_ == Field::STOPS) {
+            request_.stops.push_back(std::move(value));
         }
-        return length;
     }
     
-    json::Node JSONReader::BusInfo(json::Dict request){
-        json::Dict result;
-        const transport_catalogue::Bus* bus = catalogue_.SearchBus(request["name"s].AsString());
-        if(bus==nullptr){
-            result = { {"request_id"s, request["id"s]}, {"error_message"s, json::Node{"not found"s}}};
+    void BaseRequestsHandler::StartDict() {
+        ++depth_;
+    }
+    
+    void BaseRequestsHandler::Key(std::string&& key) {
+        if (depth_ == 3) {
+            distance_to_ = std::move(key);
+            return;
+        }
+        if (depth_ != 2) {
+            return;
+        }
+        if (key == "type"sv) {
+            field_ = Field::TYPE;
+        } else if (key == "name"sv) {
+            field_ = Field::NAME;
+        } else if (key == "latitude"sv) {
+            field_ = Field::LATITUDE;
+        } else if (key == "longitude"sv) {
+            field_ = Field::LONGITUDE;
+        } else if (key == "road_distances"sv) {
+            field_ = Field::ROAD_DISTANCES;
+        } else if (key == "stops"sv) {
+            field_ = Field::STOPS;
+        } else if (key == "is_roundtrip"sv) {
+            field_ = Field::IS_ROUNDTRIP;
+        } else {
+            field_ = Field::NONE;
+        }
+    }
+    
+    void BaseRequestsHandler::EndDict() {
+        if (--depth_ == 1) {
+            FinishRequest();
+        }
+    }
+    
+    void BaseRequestsHandler::StartArray() {
+        ++depth_;
+    }
+    
+    void BaseRequestsHandler::EndArray() {
+        if (--depth_ == 0) {
+            FinishRequests();
+        }
+    }
+    
+    void BaseRequestsHandler::FinishRequest() {
+        if (request_.type == "Stop"sv) {
+            const transport_catalogue::Stop* stop = catalogue_.AddStop(request_.name, request_.coord);
+            for (auto& [to, distance] : request_.road_distances) {
+                distances_.push_back({stop->name, std::move(to), distance});
+            }
+        } else if (request_.type == "Bus"sv) {
+            buses_.push_back({std::move(request_.name), std::move(request_.stops), request_.is_roundtrip});
+        }
+        request_.type.clear();
+        request_.name.clear();
+        request_.coord = {0., 0.};
+        request_.road_distances.clear();
+        request_.stops.clear();
+        request_.is_roundtrip = false;
+        field_ = Field::NONE;
+    }
+    
+    void BaseRequestsHandler::FinishRequests() {
+        for (const auto& [from, to, distance] : distances_) {
+            catalogue_.AddDistanceStops(from, to, distance);
+        }
+        distances_ = {};
+        
+        std::vector<std::string_view> route;
+        for (auto& bus : buses_) {
+            route.assign(bus.stops.begin(), bus.stops.end());
+            if (!bus.is_roundtrip && !route.empty()) {
+                route.insert(route.end(), std::next(route.rbegin()), route.rend());
+            }
+            catalogue_.AddBus(bus.name, route, bus.is_roundtrip);
+        }
+        buses_ = {};
+        catalogue_.Freeze();
+        is_complete_ = true;
+    }
+    
+    void JSONReader::BusInfo(const json::Dict& request, json::Writer& writer){
+        const transport_catalogue::BusStat* stat = catalogue_.GetBusStat(request.at("name"s).AsString());
+        if(stat!=nullptr && !stat->has_road_distances){
+            WriteError(request, "road distances are missing"sv, writer);
+            return;
+        }
+        writer.StartDict();
+        if(stat==nullptr){
+            writer.Key("error_message"sv).Value("not found"sv)
+                  .Key("request_id"sv).Value(request.at("id"s));
         }
          else {
-            std::vector<const transport_catalogue::Stop*> stops = catalogue_.GetInfoAboutBus(request["name"].AsString());
-            std::unordered_set uset_stops(stops.begin(), stops.end());
-            int length = CalculateRouteLength(stops);
-            double geography_length = CalculateGeographyLength(stops);
-            double curvature = static_cast<double>(length)/geography_length;
-           
-            
-            result = { {"curvature"s, json::Node{curvature}}, {"request_id"s, request["id"s]}, {"route_length"s, json::Node{length}},
-            {"stop_count"s, json::Node{static_cast<int>(stops.size())}}, 
-            {"unique_stop_count"s, json::Node{static_cast<int>(uset_stops.size())}} };
-        }
-        return json::Node{result};
-    }
-    
-    json::Node JSONReader::StopInfo(json::Dict request){
-        json::Dict result;
-        const transport_catalogue::Stop* stop = catalogue_.SearchStop(request["name"s].AsString());
+            writer.Key("curvature"sv).Value(stat->curvature)
+                  .Key("request_id"sv).Value(request.at("id"s))
+                  .Key("route_length"sv).Value(stat->route_length)
+                  .Key("stop_count"sv).Value(stat->stop_count)
+                  .Key("unique_stop_count"sv).Value(stat->unique_stop_count);
+        }
+        writer.EndDict();
+    }
+    
+    void JSONReader::StopInfo(const json::Dict& request, json::Writer& writer){
+        const transport_catalogue::Stop* stop = catalogue_.SearchStop(request.at("name"s).AsString());
+        writer.StartDict();
         if(stop==nullptr){
-            result = { {"request_id"s, request["id"s]}, {"error_message"s, json::Node{"not found"s}} };
+            writer.Key("error_message"sv).Value("not found"sv);
+        } else{
+            writer.Key("buses"sv).StartArray();
+            for(const auto bus:catalogue_.GetBusesByStop(*stop)){
+                writer.Value(bus->name);
+            }
+            writer.EndArray();
+        }
+        writer.Key("request_id"sv).Value(request.at("id"s));
+        writer.EndDict();
+    }
+    
+    void JSONReader::NearestStopsInfo(const json::Dict& request, json::Writer& writer){
+        const geo::Coordinates point{request.at("latitude"s).AsDouble(), request.at("longitude"s).AsDouble()};
+        const int count = request.at("count"s).AsInt();
+        writer.StartDict()
+              .Key("request_id"sv).Value(request.at("id"s))
+              .Key("stops"sv).StartArray();
+        for(const auto& [stop, distance]:catalogue_.GetNearestStops(point, std::max(count, 0))){
+            writer.StartDict()
+                  .Key("distance"sv).Value(distance)
+                  .Key("name"sv).Value(stop->name)
+                  .EndDict();
+        }
+        writer.EndArray().EndDict();
+    }
+    
+    void JSONReader::StopsInBoxInfo(const json::Dict& request, json::Writer& writer){
+        const geo::Coordinates min{request.at("min_latitude"s).AsDouble(), request.at("min_longitude"s).AsDouble()};
+        const geo::Coordinates max{request.at("max_latitude"s).AsDouble(), request.at("max_longitude"s).AsDouble()};
+        writer.StartDict()
+              .Key("request_id"sv).Value(request.at("id"s))
+              .Key("stops"sv).StartArray();
+        for(const auto stop:catalogue_.GetStopsInBox(min, max)){
+            writer.Value(stop->name);
+        }
+        writer.EndArray().EndDict();
+    }
+    
+    void JSONReader::MapInfo(const json::Dict& request, const map_renderer::Mapping& mapping, json::Writer& writer){
+        const std::shared_ptr<const std::string> map = map_cache_.GetMap(catalogue_, mapping);
+        writer.StartDict()
+              .Key("map"sv).Value(std::string_view(*map))
+              .Key("request_id"sv).Value(request.at("id"s))
+              .EndDict();
+    }
+    
+    void JSONReader::RouteInfo(const json::Dict& request, json::Writer& writer){
+        if(router_ == nullptr){
+            WriteError(request, "routing_settings are missing"sv, writer);
+            return;
+        }
+        const auto route = router_->BuildRoute(request.at("from"s).AsString(), request.at("to"s).AsString());
+        writer.StartDict();
+        if(!route){
+            writer.Key("error_message"sv).Value("not found"sv)
+                  .Key("request_id"sv).Value(request.at("id"s));
         } else{
-            std::set<const transport_catalogue::Bus*> buses = catalogue_.GetInfoAboutStop(request["name"].AsString());
-            json::Array arr_buses;
-            if(!buses.empty()){
-                std::vector<const transport_catalogue::Bus*> vec_buses(buses.begin(),buses.end());
-                std::sort(vec_buses.begin(), vec_buses.end(), CompareSortBus);
-                for(const auto bus:vec_buses){
-                    arr_buses.push_back(json::Node{bus->name});
+            writer.Key("items"sv).StartArray();
+            for(const auto& item:route->items){
+                writer.StartDict();
+                if(const auto* wait = std::get_if<transport_router::WaitItem>(&item)){
+                    writer.Key("stop_name"sv).Value(wait->stop->name)
+                          .Key("time"sv).Value(wait->time)
+                          .Key("type"sv).Value("Wait"sv);
+                } else{
+                    const auto& ride = std::get<transport_router::BusItem>(item);
+                    writer.Key("bus"sv).Value(ride.bus->name)
+                          .Key("span_count"sv).Value(ride.span_count)
+                          .Key("time"sv).Value(ride.time)
+                          .Key("type"sv).Value("Bus"sv);
                 }
+                writer.EndDict();
             }
-            result = { {"request_id"s, request["id"s]}, {"buses"s, json::Node{arr_buses}} };
-        }
-        return json::Node{result};
-    }
-    
-    json::Document JSONReader::StatRequests(json::Array& stat_requests, json::Array base_requests,
-                                const map_renderer::Mapping& mapping){
-        json::Array result;
-        for(size_t i = 0; i !=stat_requests.size(); ++i){
-            json::Node req;
-            json::Dict request = stat_requests[i].AsMap();
-            if (request["type"s].AsString() == "Bus"s){
-                req = BusInfo(request);
-            } else if(request["type"s].AsString() == "Stop"s){
-                req = StopInfo(request); 
-            } else{
-                req = map_renderer::DrawRoute(GetCatalouge(), base_requests, mapping, request);
+            writer.EndArray()
+                  .Key("request_id"sv).Value(request.at("id"s))
+                  .Key("total_time"sv).Value(route->total_time);
+        }
+        writer.EndDict();
+    }
+    
+    void JSONReader::DistanceMatrixInfo(const json::Dict& request, json::Writer& writer){
+        if(router_ == nullptr){
+            WriteError(request, "routing_settings are missing"sv, writer);
+            return;
+        }
+        const json::Array& names = request.at("stops"s).AsArray();
+        std::vector<transport_catalogue::StopId> stops;
+        stops.reserve(names.size());
+        for(const auto& name:names){
+            const transport_catalogue::Stop* stop = catalogue_.SearchStop(name.AsString());
+            if(stop == nullptr){
+                writer.StartDict()
+                      .Key("error_message"sv).Value("not found"sv)
+                      .Key("request_id"sv).Value(request.at("id"s))
+                      .EndDict();
+                return;
+            }
+            stops.push_back(stop->id);
+        }
+        
+        // Строки независимы и раздаются через ForEach: поток запроса считает их
+        // сам, а свободные потоки исполнителя подключаются. Большая матрица,
+        // особенно единственная в пакете, так занимает все ядра.
+        const graph::Router::TargetBuckets targets = router_->PrepareTargets(stops);
+        const size_t size = stops.size();
+        std::vector<double> times(size * size);
+        executor_.ForEach(size, [&](size_t row){
+            router_->FindTimes(stops[row], targets, std::span<double>(times).subspan(row * size, size));
+        });
+        writer.StartDict()
+              .Key("request_id"sv).Value(request.at("id"s))
+              .Key("times"sv).StartArray();
+        for(size_t row = 0; row < size; ++row){
+            writer.StartArray();
+            for(const double time:std::span<const double>(times).subspan(row * size, size)){
+                if(time == std::numeric_limits<double>::infinity()){
+                    writer.Value(nullptr);
+                } else{
+                    writer.Value(time);
+                }
             }
-            result.push_back(req);
+            writer.EndArray();
         }
-        return json::Document{json::Node{result}};
+        writer.EndArray().EndDict();
+    }
+    
+    void JSONReader::ReachableInfo(const json::Dict& request, json::Writer& writer){
+        const transport_catalogue::Stop* stop = catalogue_.SearchStop(request.at("from"s).AsString());
+        if(stop == nullptr){
+            writer.StartDict()
+                  .Key("error_message"sv).Value("not found"sv)
+                  .Key("request_id"sv).Value(request.at("id"s))
+                  .EndDict();
+            return;
+        }
+        const auto max_time = request.find("max_time"s);
+        if(max_time != request.end() && router_ == nullptr){
+            WriteError(request, "routing_settings are missing"sv, writer);
+            return;
+        }
+        writer.StartDict()
+              .Key("request_id"sv).Value(request.at("id"s));
+        // Буферы результатов свои у каждого потока и переиспользуются между запросами.
+        if(max_time != request.end()){
+            thread_local std::vector<std::pair<transport_catalogue::StopId, double>> reached;
+            router_->FindReachableStops(stop->id, max_time->second.AsDouble(), reached);
+            WriteReachedStops(catalogue_, reached, "time"sv, writer);
+        } else{
+            thread_local std::vector<std::pair<transport_catalogue::StopId, int>> reached;
+            catalogue_.FindReachableStops(stop->id, request.at("max_distance"s).AsInt(), reached);
+            WriteReachedStops(catalogue_, reached, "distance"sv, writer);
+        }
+        writer.EndDict();
+    }
+    
+    void JSONReader::StatRequests(const json::Array& stat_requests, const map_renderer::Mapping& mapping,
+                                  json::Writer& writer){
+        writer.StartArray();
+        executor_.Run(stat_requests.size(),
+                      [&](size_t i){
+                          return StatRequest(stat_requests[i].AsMap(), mapping);
+                      },
+                      [&](const std::string& answer){
+                          writer.RawValue(answer);
+                      });
+        writer.EndArray();
+    }
+    
+    std::string JSONReader::StatRequest(const json::Dict& request, const map_renderer::Mapping& mapping){
+        std::ostringstream answer;
+        json::Writer writer(answer);
+        StatRequest(request, mapping, writer);
+        return std::move(answer).str();
+    }
+    
+    void JSONReader::StatRequest(const json::Dict& request, const map_renderer::Mapping& mapping,
+                                 json::Writer& writer){
+        const std::string& type = request.at("type"s).AsString();
+        if (type == "Bus"s){
+            BusInfo(request, writer);
+        } else if(type == "Stop"s){
+            StopInfo(request, writer);
+        } else if(type == "NearestStops"s){
+            NearestStopsInfo(request, writer);
+        } else if(type == "StopsInBox"s){
+            StopsInBoxInfo(request, writer);
+        } else if(type == "Route"s){
+            RouteInfo(request, writer);
+        } else if(type == "DistanceMatrix"s){
+            DistanceMatrixInfo(request, writer);
+        } else if(type == "Reachable"s){
+            ReachableInfo(request, writer);
+        } else{
+            MapInfo(request, mapping, writer);
+        }
+    }
+    
+    void JSONReader::ProcessRequests(const json::Dict& requests, std::ostream& output,
+                                     const map_renderer::Mapping* mapping){
+        const map_renderer::Mapping settings = mapping == nullptr || requests.count("render_settings"s) != 0
+            ? map_renderer::RenderSettings(requests.at("render_settings"s).AsMap())
+            : *mapping;
+        if(requests.count("routing_settings"s) != 0){
+            SetRoutingSettings(transport_router::GetRoutingSettings(requests.at("routing_settings"s).AsMap()));
+        }
+        json::Writer writer(output);
+        StatRequests(requests.at("stat_requests"s).AsArray(), settings, writer);
+    }
+    
+    void JSONReader::SetRoutingSettings(const transport_router::RoutingSettings& settings){
+        if(!catalogue_.IsFrozen()){
+            catalogue_.Freeze();
+        }
+        router_ = std::make_unique<const transport_router::TransportRouter>(catalogue_, settings);
+    }
+    
+    void JSONReader::SetRoutingSettings(const transport_router::RoutingSettings& settings,
+                                        graph::Router::Hierarchy hierarchy){
+        if(!catalogue_.IsFrozen()){
+            catalogue_.Freeze();
+        }
+        router_ = std::make_unique<const transport_router::TransportRouter>(catalogue_, settings, std::move(hierarchy));
+    }
+    
+    json::Dict JSONReader::LoadRequests(std::istream& input){
+        RequestsHandler handler(catalogue_);
+        json::Parse(input, handler);
+        return handler.ExtractSections();
+    }
+    
+    json::Dict JSONReader::LoadRequests(std::string_view input){
+        RequestsHandler handler(catalogue_);
+        json::Parse(input, handler);
+        return handler.ExtractSections();
     }
     
     void JSONReader::Requests(std::istream& input, std::ostream& output){
-        auto node = json::Load(input).GetRoot();
-        json::Dict requests =  node.AsMap();
-        json::Array base_requests = requests["base_requests"s].AsArray();
-        BaseRequests(base_requests);
-        json::Dict render_settings = requests["render_settings"s].AsMap();
-        map_renderer::Mapping mapping = map_renderer::RenderSettings(render_settings);
-        json::Array stat_requests = requests["stat_requests"s].AsArray();
-        json::Document data = StatRequests(stat_requests, base_requests, mapping);
-        json::Print(data, output);
-    }
-}
\ No newline at end of file
+        StatRequestsPipeline pipeline(*this, output);
+        RequestsHandler handler(catalogue_, &pipeline);
+        json::Parse(input, handler);
+        pipeline.Finish();
+    }
+    
+    void JSONReader::Requests(std::string_view input, std::ostream& output){
+        StatRequestsPipeline pipeline(*this, output);
+        RequestsHandler handler(catalogue_, &pipeline);
+        json::Parse(input, handler);
+        pipeline.Finish();
+    }
+}
@@ -4,6 +4,7 @@
 #include <iosfwd>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <set>
 #include <string_view>
 #include <unordered_set>
@@ -12,11 +13,83 @@
 #include "transport_catalogue.h"
 #include  "geo.h"
 #include "map_renderer.h"
+#include "request_handler.h"
+#include "transport_router.h"
 
 using namespace std::literals;
 
 namespace json_reader{
     
+// Загружает массив base_requests в справочник прямо из событий разбора JSON,
+// не строя дерево документа. Расстояния и маршруты применяются после того,
+// как прочитан весь массив и известны все остановки.
+class BaseRequestsHandler final : public json::Handler {
+public:
+    explicit BaseRequestsHandler(transport_catalogue::TransportCatalogue& catalogue)
+        : catalogue_(catalogue) {
+    }
+    
+    void Null() override;
+    void Bool(bool value) override;
+    void Int(int value) override;
+    void Double(double value) override;
+    void String(std::string&& value) override;
+    void StartDict() override;
+    void Key(std::string&& key) override;
+    void EndDict() override;
+    void StartArray() override;
+    void EndArray() override;
+    
+    bool IsComplete() const {
+        return is_complete_;
+    }
+    
+private:
+    enum class Field {
+        NONE,
+        TYPE,
+        NAME,
+        LATITUDE,
+        LONGITUDE,
+        ROAD_DISTANCES,
+        STOPS,
+        IS_ROUNDTRIP,
+    };
+    
+    struct Request {
+        std::string type;
+        std::string name;
+        geo::Coordinates coord = {0., 0.};
+        std::vector<std::pair<std::string, int>> road_distances;
+        std::vector<std::string> stops;
+        bool is_roundtrip = false;
+    };
+    
+    struct RoadDistance {
+        std::string_view from;
+        std::string to;
+        int distance;
+    };
+    
+    struct PendingBus {
+        std::string name;
+        std::vector<std::string> stops;
+        bool is_roundtrip;
+    };
+    
+    void SetNumber(double value);
+    void FinishRequest();
+    void FinishRequests();
+    
+    transport_catalogue::TransportCatalogue& catalogue_;
+    int depth_ = 0;
+    Field field_ = Field::NONE;
+    std::string distance_to_;
+    Request request_;
+    std::vector<RoadDistance> distances_;
+    std::vector<PendingBus> buses_;
+    bool is_complete_ = false;
+};
 
     class JSONReader{
 public:
@@ -26,23 +99,61 @@ public:
     transport_catalogue::TransportCatalogue& GetCatalouge() const {
         return catalogue_;
     }
+    
+    // Число потоков, на которых выполняются stat_requests; 0 - по числу ядер.
+    void SetThreadCount(size_t thread_count) {
+        executor_.SetThreadCount(thread_count);
+    }
+    
+    request_handler::OrderedExecutor& GetExecutor() {
+        return executor_;
+    }
+    
+    // Строит маршрутизатор по замороженному справочнику для запросов Route.
+    // Может вызываться, пока выполняются запросы, не использующие маршрутизатор.
+    void SetRoutingSettings(const transport_router::RoutingSettings& settings);
+    // То же по готовой иерархии, например из снимка; см. TransportRouter.
+    void SetRoutingSettings(const transport_router::RoutingSettings& settings, graph::Router::Hierarchy hierarchy);
+    
+    const transport_router::TransportRouter* GetRouter() const {
+        return router_.get();
+    }
     void Requests(std::istream& input, std::ostream& output);
+    void Requests(std::string_view input, std::ostream& output);
     
+    // Загружает base_requests в справочник и возвращает остальные разделы запроса.
+    json::Dict LoadRequests(std::istream& input);
+    json::Dict LoadRequests(std::string_view input);
     
-private:
-    transport_catalogue::TransportCatalogue& catalogue_;
+    // Отвечает на stat_requests. Настройки отрисовки берутся из раздела
+    // render_settings, а если его нет - из mapping. Раздел routing_settings,
+    // если он есть, заменяет ранее заданные настройки маршрутизации.
+    void ProcessRequests(const json::Dict& requests, std::ostream& output,
+                         const map_renderer::Mapping* mapping = nullptr);
     
-    std::vector<std::string_view> ParseRoute(const json::Array& stops, bool is_roundtrip);
+    // Отвечает на один запрос из stat_requests. Может вызываться из нескольких
+    // потоков одновременно, пока справочник не меняется.
+    void StatRequest(const json::Dict& request, const map_renderer::Mapping& mapping, json::Writer& writer);
     
-    void BaseRequests(json::Array& base_requests);
+    // Ответ на один запрос в виде готовой строки JSON.
+    std::string StatRequest(const json::Dict& request, const map_renderer::Mapping& mapping);
     
-    double CalculateGeographyLength(const std::vector<const transport_catalogue::Stop*>& stops);
-    int CalculateRouteLength(const std::vector<const transport_catalogue::Stop*>& stops);
+private:
+    transport_catalogue::TransportCatalogue& catalogue_;
+    request_handler::OrderedExecutor executor_;
+    map_renderer::MapCache map_cache_;
+    std::unique_ptr<const transport_router::TransportRouter> router_;
     
-    json::Node BusInfo(json::Dict request);
-    json::Node StopInfo(json::Dict request);
+    void BusInfo(const json::Dict& request, json::Writer& writer);
+    void StopInfo(const json::Dict& request, json::Writer& writer);
+    void NearestStopsInfo(const json::Dict& request, json::Writer& writer);
+    void StopsInBoxInfo(const json::Dict& request, json::Writer& writer);
+    void MapInfo(const json::Dict& request, const map_renderer::Mapping& mapping, json::Writer& writer);
+    void RouteInfo(const json::Dict& request, json::Writer& writer);
+    void DistanceMatrixInfo(const json::Dict& request, json::Writer& writer);
+    void ReachableInfo(const json::Dict& request, json::Writer& writer);
     
-    json::Document StatRequests(json::Array& stat_requests, json::Array base_requests,
-                                const map_renderer::Mapping& mapping);
+    void StatRequests(const json::Array& stat_requests, const map_renderer::Mapping& mapping,
+                      json::Writer& writer);
 };
 }
\ No newline at end of file
@@ -1,10 +1,200 @@
+#include <charconv>
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
 
 #include "json_reader.h"
+#include "mapped_file.h"
+#include "serialization.h"
+#include "server.h"
 #include "transport_catalogue.h"
+#include "transport_router.h"
+
+using namespace std::literals;
+
+namespace {
+
+void PrintUsage(std::ostream& stream) {
+    stream << "Usage: transport_catalogue [requests.json]\n"
+              "       transport_catalogue make_base <snapshot> [base.json]\n"
+              "       transport_catalogue process_requests <snapshot> [requests.json]\n"
+              "       transport_catalogue serve <base.json|snapshot> [--socket <path>]\n"
+              "Options: --threads <count>  worker threads for stat_requests, 0 - one per core\n"sv;
+}
+
+// Читает запрос из файла, если он указан, иначе из стандартного ввода.
+json::Dict LoadRequests(json_reader::JSONReader& reader, const char* path) {
+    if (path != nullptr) {
+        const io::MappedFile input(path);
+        return reader.LoadRequests(input.GetData());
+    }
+    return reader.LoadRequests(std::cin);
+}
+
+void MakeBase(const std::string& snapshot_path, const char* input_path) {
+    transport_catalogue::TransportCatalogue catalogue;
+    json_reader::JSONReader reader(catalogue);
+    const json::Dict requests = LoadRequests(reader, input_path);
+    if (!catalogue.IsFrozen()) {
+        catalogue.Freeze();
+    }
+    serialization::SnapshotSettings settings;
+    if (requests.count("render_settings"s) != 0) {
+        settings.render_settings = map_renderer::RenderSettings(requests.at("render_settings"s).AsMap());
+    }
+    if (requests.count("routing_settings"s) != 0) {
+        settings.routing_settings = transport_router::GetRoutingSettings(requests.at("routing_settings"s).AsMap());
+        // Иерархия строится здесь, один раз, а не при каждой загрузке снимка.
+        settings.routing_hierarchy = transport_router::TransportRouter(catalogue, *settings.routing_settings).GetHierarchy();
+    }
+    std::ofstream output(snapshot_path, std::ios::binary);
+    if (!output) {
+        throw std::runtime_error("Cannot create " + snapshot_path);
+    }
+    serialization::SaveSnapshot(catalogue, settings, output);
+}
+
+// Строит маршрутизатор, если заданы настройки маршрутизации; иерархию из
+// снимка берёт готовой.
+void SetRouter(serialization::SnapshotSettings& settings, json_reader::JSONReader& reader) {
+    if (!settings.routing_settings) {
+        return;
+    }
+    if (settings.routing_hierarchy) {
+        reader.SetRoutingSettings(*settings.routing_settings, std::move(*settings.routing_hierarchy));
+    } else {
+        reader.SetRoutingSettings(*settings.routing_settings);
+    }
+}
+
+void ProcessRequests(const std::string& snapshot_path, const char* input_path, size_t thread_count) {
+    transport_catalogue::TransportCatalogue catalogue;
+    serialization::SnapshotSettings settings;
+    {
+        const io::MappedFile snapshot(snapshot_path);
+        settings = serialization::LoadSnapshot(snapshot.GetData(), catalogue);
+    }
+    json_reader::JSONReader reader(catalogue);
+    reader.SetThreadCount(thread_count);
+    SetRouter(settings, reader);
+    const auto& mapping = settings.render_settings;
+    reader.ProcessRequests(LoadRequests(reader, input_path), std::cout, mapping ? &*mapping : nullptr);
+}
+
+// Загружает справочник из снимка или из JSON с base_requests, строит маршрутизатор,
+// если заданы настройки маршрутизации, и возвращает настройки отрисовки.
+std::optional<map_renderer::Mapping> LoadBase(const std::string& path, transport_catalogue::TransportCatalogue& catalogue,
+                                              json_reader::JSONReader& reader) {
+    const io::MappedFile base(path);
+    serialization::SnapshotSettings settings;
+    if (serialization::IsSnapshot(base.GetData())) {
+        settings = serialization::LoadSnapshot(base.GetData(), catalogue);
+    } else {
+        const json::Dict requests = reader.LoadRequests(base.GetData());
+        if (!catalogue.IsFrozen()) {
+            catalogue.Freeze();
+        }
+        if (requests.count("render_settings"s) != 0) {
+            settings.render_settings = map_renderer::RenderSettings(requests.at("render_settings"s).AsMap());
+        }
+        if (requests.count("routing_settings"s) != 0) {
+            settings.routing_settings = transport_router::GetRoutingSettings(requests.at("routing_settings"s).AsMap());
+        }
+    }
+    SetRouter(settings, reader);
+    return std::move(settings.render_settings);
+}
+
+void Serve(const std::string& base_path, const char* socket_path, size_t thread_count) {
+    transport_catalogue::TransportCatalogue catalogue;
+    json_reader::JSONReader reader(catalogue);
+    reader.SetThreadCount(thread_count);
+    const std::optional<map_renderer::Mapping> mapping = LoadBase(base_path, catalogue, reader);
+    server::Server server(reader, mapping ? &*mapping : nullptr, std::cerr);
+    if (socket_path != nullptr) {
+        server.ServeSocket(socket_path);
+    } else {
+        server.Serve(std::cin, std::cout);
+    }
+}
+
+// Больше потоков, чем это, не нужно ни одной машине, а опечатка в числе
+// не должна порождать миллионы потоков.
+constexpr int MAX_THREAD_COUNT = 1024;
+
+// Убирает из аргументов --threads <count> и возвращает count (0, если опции нет).
+// Для отрицательного, нечислового или слишком большого count возвращает nullopt.
+std::optional<size_t> ExtractThreadCount(int& argc, char* argv[]) {
+    std::optional<size_t> thread_count = 0;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i] == "--threads"sv && i + 1 < argc) {
+            const std::string_view value = argv[++i];
+            int count = 0;
+            const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+            if (error != std::errc{} || end != value.data() + value.size() || count < 0 || count > MAX_THREAD_COUNT) {
+                thread_count = std::nullopt;
+            } else if (thread_count) {
+                thread_count = static_cast<size_t>(count);
+            }
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    return thread_count;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const std::optional<size_t> threads = ExtractThreadCount(argc, argv);
+    if (!threads) {
+        PrintUsage(std::cerr);
+        return 1;
+    }
+    const size_t thread_count = *threads;
+    const std::string_view mode = argc > 1 ? argv[1] : ""sv;
+    if (mode == "serve"sv) {
+        if (argc == 3) {
+            Serve(argv[2], nullptr, thread_count);
+        } else if (argc == 5 && argv[3] == "--socket"sv) {
+            Serve(argv[2], argv[4], thread_count);
+        } else {
+            PrintUsage(std::cerr);
+            return 1;
+        }
+        return 0;
+    }
+    if (mode == "make_base"sv || mode == "process_requests"sv) {
+        if (argc < 3 || argc > 4) {
+            PrintUsage(std::cerr);
+            return 1;
+        }
+        const char* input_path = argc == 4 ? argv[3] : nullptr;
+        if (mode == "make_base"sv) {
+            MakeBase(argv[2], input_path);
+        } else {
+            ProcessRequests(argv[2], input_path, thread_count);
+        }
+        return 0;
+    }
+    if (argc > 2) {
+        PrintUsage(std::cerr);
+        return 1;
+    }
 
-int main() {
     transport_catalogue::TransportCatalogue catalogue;
     json_reader::JSONReader json_read(catalogue);
-    json_read.Requests(std::cin, std::cout);
-}
\ No newline at end of file
+    json_read.SetThreadCount(thread_count);
+    if (argc > 1) {
+        const io::MappedFile input(argv[1]);
+        json_read.Requests(input.GetData(), std::cout);
+    } else {
+        json_read.Requests(std::cin, std::cout);
+    }
+}
@@ -19,22 +19,22 @@ svg::Color GetColor(json::Node color_node){
     return result;
 }
     
-Mapping RenderSettings(json::Dict render_settings){
+Mapping RenderSettings(const json::Dict& render_settings){
     Mapping result;
-    result.width = render_settings["width"s].AsDouble();
-    result.height = render_settings["height"s].AsDouble();
-    result.padding = render_settings["padding"s].AsDouble();
-    result.line_width = render_settings["line_width"s].AsDouble();
-    result.stop_radius = render_settings["stop_radius"s].AsDouble();
-    result.bus_label_font_size = render_settings["bus_label_font_size"s].AsInt();
-    result.bus_label_offset.first = render_settings["bus_label_offset"s].AsArray()[0].AsDouble();
-    result.bus_label_offset.second = render_settings["bus_label_offset"s].AsArray()[1].AsDouble();
-    result.stop_label_font_size = render_settings["stop_label_font_size"s].AsInt();
-    result.stop_label_offset.first = render_settings["stop_label_offset"s].AsArray()[0].AsDouble();
-    result.stop_label_offset.second = render_settings["stop_label_offset"s].AsArray()[1].AsDouble();
-    result.underlayer_color = GetColor(render_settings["underlayer_color"s]);
-    result.underlayer_width = render_settings["underlayer_width"s].AsDouble();
-    json::Array color_palette = render_settings["color_palette"s].AsArray();
+    result.width = render_settings.at("width"s).AsDouble();
+    result.height = render_settings.at("height"s).AsDouble();
+    result.padding = render_settings.at("padding"s).AsDouble();
+    result.line_width = render_settings.at("line_width"s).AsDouble();
+    result.stop_radius = render_settings.at("stop_radius"s).AsDouble();
+    result.bus_label_font_size = render_settings.at("bus_label_font_size"s).AsInt();
+    result.bus_label_offset.first = render_settings.at("bus_label_offset"s).AsArray()[0].AsDouble();
+    result.bus_label_offset.second = render_settings.at("bus_label_offset"s).AsArray()[1].AsDouble();
+    result.stop_label_font_size = render_settings.at("stop_label_font_size"s).AsInt();
+    result.stop_label_offset.first = render_settings.at("stop_label_offset"s).AsArray()[0].AsDouble();
+    result.stop_label_offset.second = render_settings.at("stop_label_offset"s).AsArray()[1].AsDouble();
+    result.underlayer_color = GetColor(render_settings.at("underlayer_color"s));
+    result.underlayer_width = render_settings.at("underlayer_width"s).AsDouble();
+    const json::Array& color_palette = render_settings.at("color_palette"s).AsArray();
         
     for(const auto& color:color_palette){
         result.color_palette.push_back(GetColor(color));
@@ -42,46 +42,31 @@ Mapping RenderSettings(json::Dict render_settings){
     return result;
 }
     
-svg::Polyline GetBusRoute(const std::vector<const transport_catalogue::Stop*>& stops, const SphereProjector proj){
-    std::vector<geo::Coordinates> geo_coords_stop;
+std::string DrawRoute(const transport_catalogue::TransportCatalogue& catalogue, const Mapping& mapping){
+    std::vector<const transport_catalogue::Bus*> buses;
         
-    for(const auto stop: stops){
-        geo_coords_stop.push_back(stop->coord);
+    for(const auto& bus : catalogue.GetBuses()){
+        buses.push_back(&bus);
     }
         
-    svg::Polyline polyline;
-        
-    for (const auto& geo_coord: geo_coords_stop) {
-        const svg::Point screen_coord = proj(geo_coord);
-        polyline.AddPoint(screen_coord);
-    }
-        
-    return polyline;  
-}
-
-json::Node DrawRoute(const transport_catalogue::TransportCatalogue& catalogue, json::Array base_requests, 
-                        const Mapping& mapping, json::Dict request){
-    std::vector<std::pair<std::string, bool>> buses;
-        
-    for(size_t i = 0; i !=base_requests.size(); ++i){
-        json::Dict request = base_requests[i].AsMap();
-        if (request["type"s].AsString() == "Bus"s){
-            buses.push_back({request["name"s].AsString(), request["is_roundtrip"s].AsBool()});
-        }
-    }
+    std::sort(buses.begin(), buses.end(),
+                [](const transport_catalogue::Bus* lhs, const transport_catalogue::Bus* rhs){
+                    return lhs->name < rhs->name; 
+                });
         
-    std::sort(buses.begin(), buses.end());
+    const auto coords = catalogue.GetStopCoordinates();
         
     const double WIDTH = mapping.width;
     const double HEIGHT = mapping.height;
     const double PADDING = mapping.padding;
         
     std::vector<const transport_catalogue::Stop*> all_stops;
-    for(const auto& bus: buses){
-        std::vector<const transport_catalogue::Stop*> stops = catalogue.GetInfoAboutBus(bus.first);
-        for(const auto stop: stops){
-            if(std::find(all_stops.begin(), all_stops.end(), stop)== all_stops.end()){
-                all_stops.push_back(stop);
+    std::vector<bool> is_used(catalogue.GetStopCount());
+    for(const auto bus: buses){
+        for(const auto id: catalogue.GetRoute(*bus)){
+            if(!is_used[id]){
+                is_used[id] = true;
+                all_stops.push_back(&catalogue.GetStop(id));
             }
         }
     }
@@ -90,20 +75,59 @@ json::Node DrawRoute(const transport_catalogue::TransportCatalogue& catalogue, j
         all_stops.begin(), all_stops.end(), WIDTH, HEIGHT, PADDING
     };
         
+    svg::PathAttrs underlayer;
+    underlayer.fill_color = mapping.underlayer_color;
+    underlayer.stroke_color = mapping.underlayer_color;
+    underlayer.stroke_width = mapping.underlayer_width;
+    underlayer.stroke_line_cap = svg::StrokeLineCap::ROUND;
+    underlayer.stroke_line_join = svg::StrokeLineJoin::ROUND;
+    
+    svg::FlatDocument doc;
+    const svg::FlatDocument::StyleId underlayer_style = doc.AddStyle(underlayer);
+    const svg::FlatDocument::FontId bus_font = doc.AddFont({
+        {mapping.bus_label_offset.first, mapping.bus_label_offset.second},
+        static_cast<uint32_t>(mapping.bus_label_font_size), "Verdana"s, "bold"s});
+    const svg::FlatDocument::FontId stop_font = doc.AddFont({
+        {mapping.stop_label_offset.first, mapping.stop_label_offset.second},
+        static_cast<uint32_t>(mapping.stop_label_font_size), "Verdana"s, {}});
+    
+    // Стили линии маршрута и подписи для каждого цвета палитры.
+    std::vector<svg::FlatDocument::StyleId> line_styles;
+    std::vector<svg::FlatDocument::StyleId> label_styles;
+    for(const auto& color : mapping.color_palette){
+        svg::PathAttrs line;
+        line.fill_color = svg::NoneColor;
+        line.stroke_color = color;
+        line.stroke_width = mapping.line_width;
+        line.stroke_line_cap = svg::StrokeLineCap::ROUND;
+        line.stroke_line_join = svg::StrokeLineJoin::ROUND;
+        line_styles.push_back(doc.AddStyle(line));
+        
+        svg::PathAttrs label;
+        label.fill_color = color;
+        label_styles.push_back(doc.AddStyle(label));
+    }
+    
+    size_t route_points = 0;
+    size_t label_size = 0;
+    for(const auto bus: buses){
+        route_points += catalogue.GetRoute(*bus).size();
+        label_size += bus->name.size() * 4;
+    }
+    for(const auto stop: all_stops){
+        label_size += stop->name.size() * 2;
+    }
+    doc.Reserve(buses.size() * 5 + all_stops.size() * 3, route_points, label_size);
+    
     size_t i = 0;
-    svg::Document doc;
-    for(const auto& [bus_name, bus_is_roundtrip]: buses){
-        std::vector<const transport_catalogue::Stop*> stops = catalogue.GetInfoAboutBus(bus_name);
+    for(const auto bus: buses){
+        const auto stops = catalogue.GetRoute(*bus);
         if(!stops.empty()){
-            const svg::Polyline polyline = GetBusRoute(stops, proj);
-                
-            doc.Add(svg::Polyline{polyline}
-                    .SetStrokeColor(mapping.color_palette[i])
-                    .SetFillColor("none"s)
-                    .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND)
-                    .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                    .SetStrokeWidth(mapping.line_width));
-                
+            doc.StartPolyline(line_styles[i]);
+            for(const auto stop : stops){
+                doc.AddPoint(proj(coords[stop]));
+            }
+            
             i++;
             if(i == mapping.color_palette.size()){
                 i = 0;
@@ -113,53 +137,17 @@ json::Node DrawRoute(const transport_catalogue::TransportCatalogue& catalogue, j
     }
         
     i = 0;
-    for(const auto& [bus_name, bus_is_roundtrip]: buses){
-        std::vector<const transport_catalogue::Stop*> stops = catalogue.GetInfoAboutBus(bus_name);
+    for(const auto bus: buses){
+        const auto stops = catalogue.GetRoute(*bus);
         if(!stops.empty()){
-            doc.Add(svg::Text()
-                    .SetPosition(proj(stops.back()->coord))
-                    .SetOffset({mapping.bus_label_offset.first, mapping.bus_label_offset.second})
-                    .SetFontSize(mapping.bus_label_font_size)
-                    .SetFontFamily("Verdana"s)
-                    .SetFontWeight("bold")
-                    .SetData(bus_name)
-                    .SetStrokeColor(mapping.underlayer_color)
-                    .SetFillColor(mapping.underlayer_color)
-                    .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND)
-                    .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                    .SetStrokeWidth(mapping.underlayer_width)); 
-                
-            doc.Add(svg::Text()
-                    .SetPosition(proj(stops.back()->coord))
-                    .SetOffset({mapping.bus_label_offset.first, mapping.bus_label_offset.second})
-                    .SetFontSize(mapping.bus_label_font_size)
-                    .SetFontFamily("Verdana"s)
-                    .SetFontWeight("bold")
-                    .SetData(bus_name)
-                    .SetFillColor(mapping.color_palette[i]));
+            const svg::Point end = proj(coords[stops.back()]);
+            doc.AddText(end, bus->name, bus_font, underlayer_style);
+            doc.AddText(end, bus->name, bus_font, label_styles[i]);
                 
-            if((!bus_is_roundtrip) && stops[stops.size()/2]->name != stops.back()->name){
-                doc.Add(svg::Text()
-                        .SetPosition(proj(stops[stops.size()/2]->coord))
-                        .SetOffset({mapping.bus_label_offset.first, mapping.bus_label_offset.second})
-                        .SetFontSize(mapping.bus_label_font_size)
-                        .SetFontFamily("Verdana"s)
-                        .SetFontWeight("bold"s)
-                        .SetData(bus_name)
-                        .SetStrokeColor(mapping.underlayer_color)
-                        .SetFillColor(mapping.underlayer_color)
-                        .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND)
-                        .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                        .SetStrokeWidth(mapping.underlayer_width));
-                    
-                doc.Add(svg::Text()
-                        .SetPosition(proj(stops[stops.size()/2]->coord))
-                        .SetOffset({mapping.bus_label_offset.first, mapping.bus_label_offset.second})
-                        .SetFontSize(mapping.bus_label_font_size)
-                        .SetFontFamily("Verdana"s)
-                        .SetFontWeight("bold"s)
-                        .SetData(bus_name)
-                        .SetFillColor(mapping.color_palette[i]));
+            if((!bus->is_roundtrip) && stops[stops.size()/2] != stops.back()){
+                const svg::Point middle = proj(coords[stops[stops.size()/2]]);
+                doc.AddText(middle, bus->name, bus_font, underlayer_style);
+                doc.AddText(middle, bus->name, bus_font, label_styles[i]);
             }
             i++;
             if(i == mapping.color_palette.size()){
@@ -173,40 +161,38 @@ json::Node DrawRoute(const transport_catalogue::TransportCatalogue& catalogue, j
                 [](const transport_catalogue::Stop* lhs,const transport_catalogue::Stop* rhs){
                     return lhs->name < rhs->name; 
                 });
-        
+    
+    svg::PathAttrs stop_circle;
+    stop_circle.fill_color = "white"s;
+    const svg::FlatDocument::StyleId stop_circle_style = doc.AddStyle(stop_circle);
     for(const auto stop:all_stops){
-        doc.Add(svg::Circle()
-                .SetCenter(proj(stop->coord))
-                .SetRadius(mapping.stop_radius)
-                .SetFillColor("white"s));
+        doc.AddCircle(proj(stop->coord), mapping.stop_radius, stop_circle_style);
     }
-        
+    
+    svg::PathAttrs stop_label;
+    stop_label.fill_color = "black"s;
+    const svg::FlatDocument::StyleId stop_label_style = doc.AddStyle(stop_label);
     for(const auto stop:all_stops){
-        doc.Add(svg::Text()
-                .SetPosition(proj(stop->coord))
-                .SetOffset({mapping.stop_label_offset.first, mapping.stop_label_offset.second})
-                .SetFontSize(mapping.stop_label_font_size)
-                .SetFontFamily("Verdana"s)
-                .SetData(stop->name)
-                .SetStrokeColor(mapping.underlayer_color)
-                .SetFillColor(mapping.underlayer_color)
-                .SetStrokeLineJoin(svg::StrokeLineJoin::ROUND)
-                .SetStrokeLineCap(svg::StrokeLineCap::ROUND)
-                .SetStrokeWidth(mapping.underlayer_width));
-            
-        doc.Add(svg::Text()
-                .SetPosition(proj(stop->coord))
-                .SetOffset({mapping.stop_label_offset.first, mapping.stop_label_offset.second})
-                .SetFontSize(mapping.stop_label_font_size)
-                .SetFontFamily("Verdana"s)
-                .SetData(stop->name)
-                .SetFillColor("black"s));
+        const svg::Point position = proj(stop->coord);
+        doc.AddText(position, stop->name, stop_font, underlayer_style);
+        doc.AddText(position, stop->name, stop_font, stop_label_style);
     }
         
-    std::stringstream ss;
-    doc.Render(ss);
-    json::Dict result = {{"map"s, json::Node{ss.str()}},{"request_id"s, request["id"s]}};
-    return json::Node{result};
+    std::string result;
+    doc.Render(result);
+    return result;
 }
     
-}
\ No newline at end of file
+std::shared_ptr<const std::string> MapCache::GetMap(const transport_catalogue::TransportCatalogue& catalogue,
+                                                    const Mapping& mapping){
+    std::lock_guard lock(mutex_);
+    if(!map_ || catalogue_ != &catalogue || version_ != catalogue.GetVersion() || *mapping_ != mapping){
+        map_ = std::make_shared<const std::string>(DrawRoute(catalogue, mapping));
+        catalogue_ = &catalogue;
+        version_ = catalogue.GetVersion();
+        mapping_ = mapping;
+    }
+    return map_;
+}
+    
+}
@@ -11,6 +11,8 @@
 #include <optional>
 #include <vector>
 #include <map>
+#include <memory>
+#include <mutex>
 
 namespace map_renderer{
     
@@ -29,6 +31,8 @@ struct Mapping{
     svg::Color underlayer_color;
     double underlayer_width;
     std::vector<svg::Color> color_palette;
+
+    bool operator==(const Mapping&) const = default;
 };
 
 inline const double EPSILON = 1e-6;
@@ -95,9 +99,23 @@ private:
 };
 
 svg::Color GetColor(json::Node color_node);    
-Mapping RenderSettings(json::Dict render_settings);   
-svg::Polyline GetBusRoute(const std::vector<const transport_catalogue::Stop*>& stops, const SphereProjector proj);
-json::Node DrawRoute(const transport_catalogue::TransportCatalogue& catalogue, json::Array base_requests, 
-                        const Mapping& mapping, json::Dict request);
+Mapping RenderSettings(const json::Dict& render_settings);   
+std::string DrawRoute(const transport_catalogue::TransportCatalogue& catalogue, const Mapping& mapping);
+
+// Хранит последнюю отрисованную карту и отдаёт её, пока не изменились ни
+// справочник, ни настройки. Безопасна для вызова из нескольких потоков:
+// карта рисуется один раз, остальные потоки ждут её готовности.
+class MapCache {
+public:
+    std::shared_ptr<const std::string> GetMap(const transport_catalogue::TransportCatalogue& catalogue,
+                                              const Mapping& mapping);
+
+private:
+    std::mutex mutex_;
+    const transport_catalogue::TransportCatalogue* catalogue_ = nullptr;
+    uint64_t version_ = 0;
+    std::optional<Mapping> mapping_;
+    std::shared_ptr<const std::string> map_;
+};
     
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace io {
+
+// Отображает файл в память только для чтения. Данные доступны, пока жив объект.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    ~MappedFile();
+
+    std::string_view GetData() const {
+        return {static_cast<const char*>(data_), size_};
+    }
+
+private:
+    void Unmap() noexcept;
+
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace io
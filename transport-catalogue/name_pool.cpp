@@ -0,0 +1,120 @@
+#include "name_pool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace transport_catalogue {
+
+size_t NamePool::Hash(std::string_view name) {
+    return std::hash<std::string_view>{}(name);
+}
+
+NameId NamePool::Intern(std::string_view name) {
+    if ((names_.size() + 1) * 2 > slots_.size()) {
+        Rehash(slots_.empty() ? 64 : slots_.size() * 2);
+    }
+    const size_t hash = Hash(name);
+    const size_t slot = FindSlot(name, hash);
+    if (slots_[slot] != NO_NAME) {
+        return slots_[slot];
+    }
+    const auto id = static_cast<NameId>(names_.size());
+    names_.push_back(Store(name));
+    hashes_.push_back(hash);
+    slots_[slot] = id;
+    return id;
+}
+
+NameId NamePool::Find(std::string_view name) const {
+    if (slots_.empty()) {
+        return NO_NAME;
+    }
+    return slots_[FindSlot(name, Hash(name))];
+}
+
+size_t NamePool::FindSlot(std::string_view name, size_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const NameId id = slots_[slot];
+        if (id == NO_NAME || (hashes_[id] == hash && names_[id] == name)) {
+            return slot;
+        }
+    }
+}
+
+NamePool::Contents NamePool::GetContents() const {
+    Contents contents;
+    for (const std::string_view name : names_) {
+        contents.chars.insert(contents.chars.end(), name.begin(), name.end());
+        contents.name_ends.push_back(static_cast<uint32_t>(contents.chars.size()));
+    }
+    contents.hashes = hashes_;
+    contents.slots = slots_;
+    return contents;
+}
+
+void NamePool::Restore(Contents contents) {
+    const size_t count = contents.name_ends.size();
+    // Поиск идёт до свободной ячейки, поэтому хотя бы одна должна быть.
+    const bool is_valid_table = std::has_single_bit(contents.slots.size()) && contents.slots.size() > count
+        && std::all_of(contents.slots.begin(), contents.slots.end(), [count](NameId id) {
+               return id == NO_NAME || id < count;
+           });
+    if (contents.hashes.size() != count || !std::is_sorted(contents.name_ends.begin(), contents.name_ends.end())
+        || (count != 0 && contents.name_ends.back() != contents.chars.size()) || (count == 0 && !contents.chars.empty())
+        || (count != 0 && !is_valid_table)) {
+        throw std::invalid_argument("Name pool contents are inconsistent");
+    }
+
+    blocks_.clear();
+    block_pos_ = nullptr;
+    block_free_ = 0;
+    names_.clear();
+    if (!contents.chars.empty()) {
+        // Все названия ложатся в один блок; в остатке блока место для новых.
+        const size_t size = std::max(BLOCK_SIZE, contents.chars.size());
+        blocks_.push_back(std::make_unique<char[]>(size));
+        std::memcpy(blocks_.back().get(), contents.chars.data(), contents.chars.size());
+        block_pos_ = blocks_.back().get() + contents.chars.size();
+        block_free_ = size - contents.chars.size();
+    }
+    names_.reserve(count);
+    uint32_t begin = 0;
+    for (const uint32_t end : contents.name_ends) {
+        names_.emplace_back(blocks_.empty() ? nullptr : blocks_.back().get() + begin, end - begin);
+        begin = end;
+    }
+    hashes_ = std::move(contents.hashes);
+    slots_ = count != 0 ? std::move(contents.slots) : std::vector<NameId>{};
+}
+
+std::string_view NamePool::Store(std::string_view name) {
+    if (name.size() > block_free_) {
+        const size_t size = std::max(BLOCK_SIZE, name.size());
+        blocks_.push_back(std::make_unique<char[]>(size));
+        block_pos_ = blocks_.back().get();
+        block_free_ = size;
+    }
+    std::memcpy(block_pos_, name.data(), name.size());
+    const std::string_view stored(block_pos_, name.size());
+    block_pos_ += name.size();
+    block_free_ -= name.size();
+    return stored;
+}
+
+void NamePool::Rehash(size_t capacity) {
+    slots_.assign(capacity, NO_NAME);
+    const size_t mask = capacity - 1;
+    for (NameId id = 0; id < names_.size(); ++id) {
+        size_t slot = hashes_[id] & mask;
+        while (slots_[slot] != NO_NAME) {
+            slot = (slot + 1) & mask;
+        }
+        slots_[slot] = id;
+    }
+}
+
+}  // namespace transport_catalogue
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace transport_catalogue {
+
+using NameId = uint32_t;
+
+// Хранит каждое название остановки или автобуса в единственном экземпляре и
+// выдаёт ему постоянный номер. Строки лежат в крупных блоках памяти, которые
+// не перемещаются, поэтому string_view на них действительны всё время жизни пула.
+// Хеши названий считаются один раз при добавлении и хранятся рядом с ними.
+class NamePool {
+public:
+    static constexpr NameId NO_NAME = std::numeric_limits<NameId>::max();
+
+    NameId Intern(std::string_view name);
+
+    // Номер названия или NO_NAME, если такого названия нет.
+    NameId Find(std::string_view name) const;
+
+    std::string_view GetName(NameId id) const {
+        return names_[id];
+    }
+
+    size_t GetHash(NameId id) const {
+        return hashes_[id];
+    }
+
+    size_t GetSize() const {
+        return names_.size();
+    }
+
+    static size_t Hash(std::string_view name);
+
+    // Содержимое пула плоскими массивами: названия подряд в chars, название
+    // id кончается на name_ends[id]; хеши и таблица поиска - как есть.
+    struct Contents {
+        std::vector<char> chars;
+        std::vector<uint32_t> name_ends;
+        std::vector<size_t> hashes;
+        std::vector<NameId> slots;
+    };
+
+    Contents GetContents() const;
+
+    // Заменяет содержимое пула, не пересчитывая хеши и таблицу поиска.
+    // Выбрасывает std::invalid_argument, если массивы не согласованы.
+    void Restore(Contents contents);
+
+private:
+    static constexpr size_t BLOCK_SIZE = 1 << 16;
+
+    size_t FindSlot(std::string_view name, size_t hash) const;
+    std::string_view Store(std::string_view name);
+    void Rehash(size_t capacity);
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* block_pos_ = nullptr;
+    size_t block_free_ = 0;
+    std::vector<std::string_view> names_;
+    std::vector<size_t> hashes_;
+    // Открытая адресация с линейным пробированием; размер - степень двойки.
+    std::vector<NameId> slots_;
+};
+
+}  // namespace transport_catalogue
@@ -0,0 +1,168 @@
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace transport_catalogue {
+
+namespace {
+
+uint64_t Mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+}
+
+}  // namespace
+
+size_t PerfectHashIndex::GetSlot(size_t hash, uint32_t seed) const {
+    if (seed & DIRECT_SLOT) {
+        return seed & ~DIRECT_SLOT;
+    }
+    return Mix(hash ^ (seed * 0x9e3779b97f4a7c15ULL)) % slots_.size();
+}
+
+void PerfectHashIndex::Build(std::span<const std::string_view> keys, std::span<const size_t> hashes,
+                             std::span<const uint32_t> values) {
+    const size_t count = keys.size();
+    is_fallback_ = false;
+    fallback_.clear();
+    seeds_.assign(count / 2 + 1, 0);
+    slots_.assign(count, {});
+    if (count == 0) {
+        return;
+    }
+
+    std::vector<std::vector<uint32_t>> buckets(seeds_.size());
+    for (uint32_t i = 0; i < count; ++i) {
+        buckets[GetBucket(hashes[i])].push_back(i);
+    }
+    std::vector<uint32_t> order(buckets.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t lhs, uint32_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    std::vector<bool> taken(count, false);
+    std::vector<size_t> chosen;
+    size_t next_free = 0;
+    for (uint32_t bucket : order) {
+        const auto& items = buckets[bucket];
+        if (items.empty()) {
+            break;
+        }
+        if (items.size() == 1) {
+            while (taken[next_free]) {
+                ++next_free;
+            }
+            seeds_[bucket] = DIRECT_SLOT | static_cast<uint32_t>(next_free);
+        } else {
+            // Ищем зерно, при котором все ключи корзины попадают в разные свободные ячейки.
+            for (uint32_t seed = 1;; ++seed) {
+                if (seed > MAX_SEED_ATTEMPTS) {
+                    BuildFallback(keys, values);
+                    return;
+                }
+                chosen.clear();
+                for (uint32_t item : items) {
+                    const size_t slot = GetSlot(hashes[item], seed);
+                    if (taken[slot] || std::find(chosen.begin(), chosen.end(), slot) != chosen.end()) {
+                        break;
+                    }
+                    chosen.push_back(slot);
+                }
+                if (chosen.size() == items.size()) {
+                    seeds_[bucket] = seed;
+                    break;
+                }
+            }
+        }
+        for (uint32_t item : items) {
+            const size_t slot = GetSlot(hashes[item], seeds_[bucket]);
+            taken[slot] = true;
+            slots_[slot] = {hashes[item], keys[item], values[item]};
+        }
+    }
+}
+
+void PerfectHashIndex::BuildFallback(std::span<const std::string_view> keys, std::span<const uint32_t> values) {
+    seeds_.clear();
+    slots_.clear();
+    is_fallback_ = true;
+    fallback_.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        fallback_.emplace(keys[i], values[i]);
+    }
+}
+
+PerfectHashIndex::Table PerfectHashIndex::GetTable() const {
+    Table table;
+    table.is_fallback = is_fallback_;
+    if (is_fallback_) {
+        for (const auto& [key, value] : fallback_) {
+            table.values.push_back(value);
+        }
+        std::sort(table.values.begin(), table.values.end());
+        return table;
+    }
+    table.seeds = seeds_;
+    for (const Slot& slot : slots_) {
+        table.values.push_back(slot.value);
+    }
+    return table;
+}
+
+void PerfectHashIndex::Restore(Table table, std::span<const std::string_view> keys, std::span<const size_t> hashes) {
+    const size_t count = table.values.size();
+    const bool is_valid_values = keys.size() == hashes.size()
+        && std::all_of(table.values.begin(), table.values.end(), [&keys](uint32_t value) {
+               return value < keys.size();
+           });
+    // Зерно с флагом DIRECT_SLOT - номер ячейки, он должен быть в таблице.
+    const bool is_valid_seeds = table.is_fallback
+        ? table.seeds.empty()
+        : table.seeds.size() == count / 2 + 1
+              && std::all_of(table.seeds.begin(), table.seeds.end(), [count](uint32_t seed) {
+                     return !(seed & DIRECT_SLOT) || (seed & ~DIRECT_SLOT) < count;
+                 });
+    if (!is_valid_values || !is_valid_seeds) {
+        throw std::invalid_argument("Perfect hash table is inconsistent");
+    }
+
+    seeds_ = std::move(table.seeds);
+    slots_.clear();
+    fallback_.clear();
+    is_fallback_ = table.is_fallback;
+    if (is_fallback_) {
+        fallback_.reserve(count);
+        for (uint32_t value : table.values) {
+            fallback_.emplace(keys[value], value);
+        }
+        return;
+    }
+    slots_.reserve(count);
+    for (uint32_t value : table.values) {
+        slots_.push_back({hashes[value], keys[value], value});
+    }
+}
+
+uint32_t PerfectHashIndex::Find(std::string_view key, size_t hash) const {
+    if (is_fallback_) {
+        const auto it = fallback_.find(key);
+        return it != fallback_.end() ? it->second : NOT_FOUND;
+    }
+    if (slots_.empty()) {
+        return NOT_FOUND;
+    }
+    const Slot& slot = slots_[GetSlot(hash, seeds_[GetBucket(hash)])];
+    if (slot.hash != hash || slot.key != key) {
+        return NOT_FOUND;
+    }
+    return slot.value;
+}
+
+}  // namespace transport_catalogue
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace transport_catalogue {
+
+// Минимальная совершенная хеш-таблица над неизменяемым набором различных строк
+// (схема hash-and-displace). Ключи разбиты на корзины; для каждой корзины при
+// построении подбирается зерно, разводящее её ключи по свободным ячейкам, так
+// что каждому ключу соответствует ровно одна ячейка. Поиск, в том числе
+// неудачный, - одно вычисление хеша, одно обращение к ячейке и сравнение
+// сохранённого хеша.
+class PerfectHashIndex {
+public:
+    static constexpr uint32_t NOT_FOUND = std::numeric_limits<uint32_t>::max();
+
+    // hashes[i] должен быть равен Hash(keys[i]); строки keys должны жить дольше индекса.
+    // Если для какой-то корзины зерно не находится за MAX_SEED_ATTEMPTS попыток
+    // (например, у разных ключей совпали хеши целиком), индекс становится
+    // обычной хеш-таблицей.
+    void Build(std::span<const std::string_view> keys, std::span<const size_t> hashes,
+               std::span<const uint32_t> values);
+
+    uint32_t Find(std::string_view key, size_t hash) const;
+
+    // Построенная таблица без ключей: зёрна и значения ячеек. В режиме
+    // обычной хеш-таблицы зёрен нет, а значения перечислены по возрастанию.
+    struct Table {
+        std::vector<uint32_t> seeds;
+        std::vector<uint32_t> values;
+        bool is_fallback = false;
+    };
+
+    Table GetTable() const;
+
+    // Заменяет индекс таблицей, сохранённой через GetTable; ключ и хеш
+    // значения value - keys[value] и hashes[value]. Выбрасывает
+    // std::invalid_argument, если таблица не согласована или значение вне keys.
+    void Restore(Table table, std::span<const std::string_view> keys, std::span<const size_t> hashes);
+
+private:
+    struct Slot {
+        size_t hash = 0;
+        std::string_view key;
+        uint32_t value = NOT_FOUND;
+    };
+
+    // Корзина из одного ключа кладётся прямо в свободную ячейку, номер которой
+    // хранится вместо зерна с этим флагом.
+    static constexpr uint32_t DIRECT_SLOT = 1u << 31;
+    static constexpr uint32_t MAX_SEED_ATTEMPTS = 1u << 16;
+
+    size_t GetBucket(size_t hash) const {
+        return hash % seeds_.size();
+    }
+
+    size_t GetSlot(size_t hash, uint32_t seed) const;
+
+    void BuildFallback(std::span<const std::string_view> keys, std::span<const uint32_t> values);
+
+    std::vector<uint32_t> seeds_;
+    std::vector<Slot> slots_;
+    bool is_fallback_ = false;
+    std::unordered_map<std::string_view, uint32_t> fallback_;
+};
+
+}  // namespace transport_catalogue
@@ -1,9 +1,140 @@
 #include "request_handler.h"
 
-/*
- * Здесь можно было бы разместить код обработчика запросов к базе, содержащего логику, которую не
- * хотелось бы помещать ни в transport_catalogue, ни в json reader.
- *
- * Если вы затрудняетесь выбрать, что можно было бы поместить в этот файл,
- * можете оставить его пустым.
- */
\ No newline at end of file
+namespace request_handler {
+
+namespace {
+
+thread_local bool is_worker_thread = false;
+
+}  // namespace
+
+void OrderedExecutor::SetThreadCount(size_t thread_count) {
+    StopWorkers();
+    thread_count_ = thread_count != 0 ? thread_count : std::max(1u, std::thread::hardware_concurrency());
+    // С одним потоком задания выполняет вызывающий, рабочие не нужны.
+    if (thread_count_ <= 1) {
+        return;
+    }
+    is_stopping_ = false;
+    workers_.reserve(thread_count_);
+    for (size_t i = 0; i < thread_count_; ++i) {
+        workers_.emplace_back([this] {
+            Work();
+        });
+    }
+}
+
+bool OrderedExecutor::IsWorkerThread() {
+    return is_worker_thread;
+}
+
+void OrderedExecutor::StartBatch(size_t count, const std::function<void(size_t)>& process) {
+    std::lock_guard lock(mutex_);
+    process_ = &process;
+    count_ = count;
+    next_task_.store(0, std::memory_order_relaxed);
+    ++generation_;
+    batch_ready_.notify_all();
+}
+
+void OrderedExecutor::FinishBatch() {
+    std::unique_lock lock(mutex_);
+    // Опоздавшие потоки больше не берутся за эти задания.
+    process_ = nullptr;
+    batch_done_.wait(lock, [this] {
+        return busy_workers_ == 0;
+    });
+}
+
+void OrderedExecutor::RunGroup(size_t count, const std::function<void(size_t)>& process) {
+    Group group(process, count);
+    {
+        std::lock_guard lock(mutex_);
+        groups_.push_back(&group);
+        batch_ready_.notify_all();
+    }
+    ProcessGroup(group);
+    std::unique_lock lock(mutex_);
+    RemoveGroup(group);
+    group_done_.wait(lock, [&group] {
+        return group.helpers == 0;
+    });
+    if (group.error) {
+        std::rethrow_exception(group.error);
+    }
+}
+
+void OrderedExecutor::ProcessGroup(Group& group) {
+    for (size_t i = group.next_task.fetch_add(1, std::memory_order_relaxed); i < group.count;
+         i = group.next_task.fetch_add(1, std::memory_order_relaxed)) {
+        try {
+            (*group.process)(i);
+        } catch (...) {
+            std::lock_guard lock(mutex_);
+            if (!group.error) {
+                group.error = std::current_exception();
+            }
+            group.next_task.store(group.count, std::memory_order_relaxed);
+        }
+    }
+}
+
+void OrderedExecutor::RemoveGroup(const Group& group) {
+    const auto it = std::find(groups_.begin(), groups_.end(), &group);
+    if (it != groups_.end()) {
+        groups_.erase(it);
+    }
+}
+
+void OrderedExecutor::Work() {
+    is_worker_thread = true;
+    uint64_t generation = 0;
+    std::unique_lock lock(mutex_);
+    while (true) {
+        batch_ready_.wait(lock, [&] {
+            return is_stopping_ || (process_ != nullptr && generation_ != generation) || !groups_.empty();
+        });
+        if (is_stopping_) {
+            return;
+        }
+        if (process_ != nullptr && generation_ != generation) {
+            generation = generation_;
+            const std::function<void(size_t)>* process = process_;
+            const size_t count = count_;
+            ++busy_workers_;
+            lock.unlock();
+            for (size_t i = next_task_.fetch_add(1, std::memory_order_relaxed); i < count;
+                 i = next_task_.fetch_add(1, std::memory_order_relaxed)) {
+                (*process)(i);
+            }
+            lock.lock();
+            if (--busy_workers_ == 0) {
+                batch_done_.notify_all();
+            }
+            continue;
+        }
+
+        // Помогаем самому раннему вызову ForEach. Кто первым увидел, что
+        // заданий в группе не осталось, убирает её из очереди.
+        Group& group = *groups_.front();
+        ++group.helpers;
+        lock.unlock();
+        ProcessGroup(group);
+        lock.lock();
+        RemoveGroup(group);
+        if (--group.helpers == 0) {
+            group_done_.notify_all();
+        }
+    }
+}
+
+void OrderedExecutor::StopWorkers() {
+    {
+        std::lock_guard lock(mutex_);
+        is_stopping_ = true;
+        batch_ready_.notify_all();
+    }
+    workers_.clear();
+}
+
+}  // namespace request_handler
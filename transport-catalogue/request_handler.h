@@ -1,37 +1,363 @@
 #pragma once
 
-/*
- * Здесь можно было бы разместить код обработчика запросов к базе, содержащего логику, которую не
- * хотелось бы помещать ни в transport_catalogue, ни в json reader.
- *
- * В качестве источника для идей предлагаем взглянуть на нашу версию обработчика запросов.
- * Вы можете реализовать обработку запросов способом, который удобнее вам.
- *
- * Если вы затрудняетесь выбрать, что можно было бы поместить в этот файл,
- * можете оставить его пустым.
- */
-
-// Класс RequestHandler играет роль Фасада, упрощающего взаимодействие JSON reader-а
-// с другими подсистемами приложения.
-// См. паттерн проектирования Фасад: https://ru.wikipedia.org/wiki/Фасад_(шаблон_проектирования)
-/*
-class RequestHandler {
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace request_handler {
+
+// Выполняет независимые запросы к замороженному справочнику на нескольких
+// потоках. Потоки создаются один раз и переиспользуются всеми вызовами Run;
+// они берут запросы по одному из общего счётчика, поэтому долгий запрос Map
+// занимает только свой поток и не задерживает остальные. Ответы передаются
+// вызывающему потоку строго в порядке запросов, как только готов очередной
+// из них.
+class OrderedExecutor {
 public:
-    // MapRenderer понадобится в следующей части итогового проекта
-    RequestHandler(const TransportCatalogue& db, const renderer::MapRenderer& renderer);
+    // thread_count == 0 - по числу аппаратных потоков.
+    explicit OrderedExecutor(size_t thread_count = 0) {
+        SetThreadCount(thread_count);
+    }
+
+    OrderedExecutor(const OrderedExecutor&) = delete;
+    OrderedExecutor& operator=(const OrderedExecutor&) = delete;
+
+    ~OrderedExecutor() {
+        StopWorkers();
+    }
+
+    // Пересоздаёт рабочие потоки; не вызывается одновременно с Run.
+    void SetThreadCount(size_t thread_count);
 
-    // Возвращает информацию о маршруте (запрос Bus)
-    std::optional<BusStat> GetBusStat(const std::string_view& bus_name) const;
+    size_t GetThreadCount() const {
+        return thread_count_;
+    }
 
-    // Возвращает маршруты, проходящие через
-    const std::unordered_set<BusPtr>* GetBusesByStop(const std::string_view& stop_name) const;
+    // Вызывает task(i) для каждого i из [0, count) и передаёт возвращённые
+    // строки в emit(const std::string&) по возрастанию i. task вызывается
+    // из рабочих потоков, emit - только из вызывающего. Исключение из task
+    // останавливает выдачу и пробрасывается, когда рабочие потоки оставят
+    // задания. Вызовы из разных потоков выполняются по очереди, а вызов из
+    // самого task - последовательно в его потоке.
+    template <typename Task, typename Emit>
+    void Run(size_t count, Task&& task, Emit&& emit);
 
-    // Этот метод будет нужен в следующей части итогового проекта
-    svg::Document RenderMap() const;
+    // Вызывает task(i) для каждого i из [0, count) в произвольном порядке и
+    // возвращает управление, когда все вызовы закончены. Можно вызывать из
+    // любого потока, в том числе из task внутри Run: вызывающий выполняет
+    // задания сам, а свободные рабочие потоки ему помогают, поэтому вложенный
+    // вызов не ждёт занятых потоков. Первое исключение из task пробрасывается
+    // после того, как начатые вызовы закончены; остальные задания отменяются.
+    template <typename Task>
+    void ForEach(size_t count, Task&& task);
 
 private:
-    // RequestHandler использует агрегацию объектов "Транспортный Справочник" и "Визуализатор Карты"
-    const TransportCatalogue& db_;
-    const renderer::MapRenderer& renderer_;
+    // Задания одного вызова ForEach, к которым могут подключиться свободные потоки.
+    struct Group {
+        Group(const std::function<void(size_t)>& process, size_t count)
+            : process(&process), count(count) {
+        }
+
+        const std::function<void(size_t)>* process;
+        size_t count;
+        std::atomic<size_t> next_task = 0;
+        // Поля ниже защищены mutex_.
+        size_t helpers = 0;
+        std::exception_ptr error;
+    };
+
+    static bool IsWorkerThread();
+
+    void RunGroup(size_t count, const std::function<void(size_t)>& process);
+    void ProcessGroup(Group& group);
+    // Убирает группу из очереди, чтобы за неё больше не брались; mutex_ захвачен.
+    void RemoveGroup(const Group& group);
+
+    // Раздаёт рабочим потокам вызовы process(i) для i из [0, count).
+    void StartBatch(size_t count, const std::function<void(size_t)>& process);
+    // Дожидается, пока все рабочие потоки оставят текущие задания.
+    void FinishBatch();
+    void Work();
+    void StopWorkers();
+
+    size_t thread_count_ = 1;
+    std::vector<std::jthread> workers_;
+    std::mutex run_mutex_;
+
+    std::mutex mutex_;
+    std::condition_variable batch_ready_;
+    std::condition_variable batch_done_;
+    const std::function<void(size_t)>* process_ = nullptr;
+    size_t count_ = 0;
+    std::atomic<size_t> next_task_ = 0;
+    // Растёт с каждым StartBatch, чтобы поток не брался за одни задания дважды.
+    uint64_t generation_ = 0;
+    size_t busy_workers_ = 0;
+    // Незавершённые вызовы ForEach; каждый живёт в стеке вызвавшего его потока.
+    std::vector<Group*> groups_;
+    std::condition_variable group_done_;
+    bool is_stopping_ = false;
 };
-*/
\ No newline at end of file
+
+template <typename Task, typename Emit>
+void OrderedExecutor::Run(size_t count, Task&& task, Emit&& emit) {
+    if (workers_.empty() || count <= 1 || IsWorkerThread()) {
+        for (size_t i = 0; i < count; ++i) {
+            emit(task(i));
+        }
+        return;
+    }
+
+    std::lock_guard run_lock(run_mutex_);
+    std::vector<std::string> results(count);
+    std::vector<char> is_ready(count, 0);
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable result_ready;
+    std::atomic<bool> is_stopped = false;
+
+    const std::function<void(size_t)> process = [&](size_t i) {
+        if (is_stopped.load(std::memory_order_relaxed)) {
+            return;
+        }
+        try {
+            std::string result = task(i);
+            std::lock_guard lock(mutex);
+            results[i] = std::move(result);
+            is_ready[i] = 1;
+        } catch (...) {
+            std::lock_guard lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            is_stopped = true;
+        }
+        result_ready.notify_one();
+    };
+
+    StartBatch(count, process);
+    try {
+        for (size_t i = 0; i < count; ++i) {
+            std::string result;
+            {
+                std::unique_lock lock(mutex);
+                result_ready.wait(lock, [&] {
+                    return is_ready[i] || error;
+                });
+                if (!is_ready[i]) {
+                    break;
+                }
+                result = std::move(results[i]);
+            }
+            emit(result);
+        }
+    } catch (...) {
+        is_stopped = true;
+        FinishBatch();
+        throw;
+    }
+    FinishBatch();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+template <typename Task>
+void OrderedExecutor::ForEach(size_t count, Task&& task) {
+    if (workers_.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+    const std::function<void(size_t)> process = [&task](size_t i) {
+        task(i);
+    };
+    RunGroup(count, process);
+}
+
+// Конвейер обработки: задания поступают по одному по мере разбора входа,
+// выполняются рабочими потоками, а готовые ответы выводит отдельный поток
+// записи строго в порядке поступления. Между Push и выводом одновременно
+// находится не больше capacity заданий: если вывод не успевает, Push ждёт.
+template <typename Job>
+class OrderedPipeline {
+public:
+    using Process = std::function<std::string(Job&)>;
+    using Emit = std::function<void(const std::string&)>;
+
+    OrderedPipeline(size_t thread_count, size_t capacity, Process process, Emit emit);
+
+    OrderedPipeline(const OrderedPipeline&) = delete;
+    OrderedPipeline& operator=(const OrderedPipeline&) = delete;
+
+    // Без вызова Finish() невыполненные задания отбрасываются.
+    ~OrderedPipeline() {
+        Stop(true);
+    }
+
+    // После ошибки в process или emit новые задания молча отбрасываются.
+    void Push(Job job);
+
+    // Дожидается вывода всех заданий и пробрасывает первую ошибку.
+    void Finish();
+
+private:
+    void Work();
+    void Write();
+    void Fail(std::exception_ptr error);
+    void Stop(bool cancel);
+
+    Process process_;
+    Emit emit_;
+    size_t capacity_;
+
+    std::mutex mutex_;
+    std::condition_variable job_ready_;
+    std::condition_variable result_ready_;
+    std::condition_variable space_ready_;
+    std::deque<std::pair<size_t, Job>> jobs_;
+    // Ответы заданий, начиная с ещё не выведенного next_write_.
+    std::deque<std::optional<std::string>> results_;
+    size_t next_index_ = 0;
+    size_t next_write_ = 0;
+    bool is_closed_ = false;
+    bool is_cancelled_ = false;
+    std::exception_ptr error_;
+
+    std::vector<std::jthread> workers_;
+    std::jthread writer_;
+};
+
+template <typename Job>
+OrderedPipeline<Job>::OrderedPipeline(size_t thread_count, size_t capacity, Process process, Emit emit)
+    : process_(std::move(process))
+    , emit_(std::move(emit))
+    , capacity_(std::max<size_t>(capacity, 1)) {
+    workers_.reserve(thread_count);
+    for (size_t i = 0; i < std::max<size_t>(thread_count, 1); ++i) {
+        workers_.emplace_back([this] {
+            Work();
+        });
+    }
+    writer_ = std::jthread([this] {
+        Write();
+    });
+}
+
+template <typename Job>
+void OrderedPipeline<Job>::Push(Job job) {
+    std::unique_lock lock(mutex_);
+    space_ready_.wait(lock, [this] {
+        return next_index_ - next_write_ < capacity_ || is_cancelled_;
+    });
+    if (is_cancelled_) {
+        return;
+    }
+    results_.emplace_back();
+    jobs_.emplace_back(next_index_++, std::move(job));
+    job_ready_.notify_one();
+}
+
+template <typename Job>
+void OrderedPipeline<Job>::Finish() {
+    Stop(false);
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+template <typename Job>
+void OrderedPipeline<Job>::Work() {
+    while (true) {
+        std::pair<size_t, Job> job;
+        {
+            std::unique_lock lock(mutex_);
+            job_ready_.wait(lock, [this] {
+                return !jobs_.empty() || is_closed_ || is_cancelled_;
+            });
+            if (jobs_.empty() || is_cancelled_) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        try {
+            std::string result = process_(job.second);
+            std::lock_guard lock(mutex_);
+            if (job.first == next_write_) {
+                result_ready_.notify_one();
+            }
+            results_[job.first - next_write_] = std::move(result);
+        } catch (...) {
+            Fail(std::current_exception());
+            return;
+        }
+    }
+}
+
+template <typename Job>
+void OrderedPipeline<Job>::Write() {
+    while (true) {
+        std::string result;
+        {
+            std::unique_lock lock(mutex_);
+            result_ready_.wait(lock, [this] {
+                return (!results_.empty() && results_.front()) || (is_closed_ && results_.empty()) || is_cancelled_;
+            });
+            if (is_cancelled_ || results_.empty()) {
+                return;
+            }
+            result = std::move(*results_.front());
+            results_.pop_front();
+            ++next_write_;
+            space_ready_.notify_one();
+        }
+        try {
+            emit_(result);
+        } catch (...) {
+            Fail(std::current_exception());
+            return;
+        }
+    }
+}
+
+template <typename Job>
+void OrderedPipeline<Job>::Fail(std::exception_ptr error) {
+    std::lock_guard lock(mutex_);
+    if (!error_) {
+        error_ = error;
+    }
+    is_cancelled_ = true;
+    job_ready_.notify_all();
+    result_ready_.notify_all();
+    space_ready_.notify_all();
+}
+
+template <typename Job>
+void OrderedPipeline<Job>::Stop(bool cancel) {
+    {
+        std::lock_guard lock(mutex_);
+        is_closed_ = true;
+        is_cancelled_ = is_cancelled_ || cancel;
+        job_ready_.notify_all();
+        result_ready_.notify_all();
+        space_ready_.notify_all();
+    }
+    workers_.clear();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+}  // namespace request_handler
@@ -0,0 +1,568 @@
+#include "router.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace graph {
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+// Поиск свидетеля смотрит только пути из стольких дуг и останавливается после
+// стольких вершин: если он не нашёл обходной путь, добавляется, возможно,
+// лишнее, но корректное сокращение.
+constexpr uint32_t WITNESS_HOP_LIMIT = 5;
+constexpr size_t WITNESS_SETTLE_LIMIT = 50;
+
+// Сжатие останавливается, когда у оставшихся вершин в среднем больше стольких
+// дуг: дальше каждое исключение добавляет всё больше сокращений и поиски
+// свидетелей дорожают, а по плотному ядру запрос проходит двусторонним Дейкстрой.
+constexpr size_t CORE_DEGREE_LIMIT = 16;
+
+using QueueItem = std::pair<double, VertexId>;
+
+void PushQueue(std::vector<QueueItem>& queue, double distance, VertexId vertex) {
+    queue.emplace_back(distance, vertex);
+    std::push_heap(queue.begin(), queue.end(), std::greater<>{});
+}
+
+QueueItem PopQueue(std::vector<QueueItem>& queue) {
+    std::pop_heap(queue.begin(), queue.end(), std::greater<>{});
+    const QueueItem item = queue.back();
+    queue.pop_back();
+    return item;
+}
+
+// Рабочие массивы запроса, свои у каждого потока. После запроса в dist
+// восстанавливается INF только для затронутых вершин, поэтому запрос не
+// выделяет память и не зависит от размера графа.
+struct SearchScratch {
+    std::vector<double> dist[2];
+    std::vector<uint32_t> parent[2];
+    std::vector<VertexId> touched;
+    std::vector<QueueItem> queue[2];
+    // Вершины ядра, до которых дошёл поиск по иерархии.
+    std::vector<VertexId> core_entries[2];
+
+    void Prepare(size_t vertex_count) {
+        for (int dir = 0; dir < 2; ++dir) {
+            if (dist[dir].size() < vertex_count) {
+                dist[dir].resize(vertex_count, INF);
+                parent[dir].resize(vertex_count);
+            }
+            queue[dir].clear();
+            core_entries[dir].clear();
+        }
+    }
+
+    void Set(int dir, VertexId vertex, double distance, uint32_t arc) {
+        if (dist[0][vertex] == INF && dist[1][vertex] == INF) {
+            touched.push_back(vertex);
+        }
+        dist[dir][vertex] = distance;
+        parent[dir][vertex] = arc;
+    }
+
+    void Reset() {
+        for (VertexId vertex : touched) {
+            dist[0][vertex] = INF;
+            dist[1][vertex] = INF;
+        }
+        touched.clear();
+    }
+};
+
+SearchScratch& GetScratch(size_t vertex_count) {
+    thread_local SearchScratch scratch;
+    scratch.Prepare(vertex_count);
+    return scratch;
+}
+
+}  // namespace
+
+// Состояние построения иерархии. Списки смежности хранят только дуги между
+// ещё не исключёнными вершинами: в UpArc::to записан другой конец дуги.
+class Router::Contraction {
+public:
+    Contraction(const DirectedWeightedGraph& graph, Router& router)
+        : router_(router)
+        , arcs_(router.arcs_)
+        , vertex_count_(graph.GetVertexCount())
+        , out_(vertex_count_)
+        , in_(vertex_count_)
+        , up_out_(vertex_count_)
+        , up_in_(vertex_count_)
+        , is_contracted_(vertex_count_, false)
+        , contracted_neighbours_(vertex_count_, 0)
+        , witness_dist_(vertex_count_, INF)
+        , witness_hops_(vertex_count_, 0) {
+        AddOriginalArcs(graph);
+    }
+
+    void Run() {
+        std::vector<std::pair<int, VertexId>> queue;
+        queue.reserve(vertex_count_);
+        for (VertexId v = 0; v < vertex_count_; ++v) {
+            queue.emplace_back(GetPriority(v), v);
+        }
+        std::make_heap(queue.begin(), queue.end(), std::greater<>{});
+
+        // Приоритеты соседей меняются после каждого сжатия; они пересчитываются
+        // при извлечении, и вершина сжимается, только если осталась первой, -
+        // теми сокращениями, что найдены при пересчёте.
+        while (!queue.empty() && live_arc_count_ * 2 <= CORE_DEGREE_LIMIT * queue.size()) {
+            std::pop_heap(queue.begin(), queue.end(), std::greater<>{});
+            const VertexId v = queue.back().second;
+            queue.pop_back();
+            const int priority = GetPriority(v);
+            if (!queue.empty() && priority > queue.front().first) {
+                queue.emplace_back(priority, v);
+                std::push_heap(queue.begin(), queue.end(), std::greater<>{});
+                continue;
+            }
+            Contract(v);
+        }
+        // Оставшиеся вершины образуют ядро, все их дуги попадают в иерархию.
+        for (VertexId v = 0; v < vertex_count_; ++v) {
+            if (!is_contracted_[v]) {
+                router_.core_.push_back(v);
+                up_out_[v] = std::move(out_[v]);
+                up_in_[v] = std::move(in_[v]);
+            }
+        }
+        BuildUpwardArcs(up_out_, router_.forward_offsets_, router_.forward_arcs_);
+        BuildUpwardArcs(up_in_, router_.backward_offsets_, router_.backward_arcs_);
+    }
+
+private:
+    struct Shortcut {
+        VertexId from;
+        VertexId to;
+        double weight;
+        uint32_t first;
+        uint32_t second;
+    };
+
+    void AddOriginalArcs(const DirectedWeightedGraph& graph) {
+        // Из кратных рёбер остаётся самое лёгкое, при равенстве - с меньшим номером.
+        std::vector<uint32_t> arc_to(vertex_count_, NO_ARC);
+        for (VertexId from = 0; from < vertex_count_; ++from) {
+            const size_t first_arc = arcs_.size();
+            for (EdgeId id : graph.GetIncidentEdges(from)) {
+                const Edge& edge = graph.GetEdge(id);
+                if (edge.to == from) {
+                    continue;
+                }
+                uint32_t& arc = arc_to[edge.to];
+                if (arc == NO_ARC) {
+                    arc = static_cast<uint32_t>(arcs_.size());
+                    arcs_.push_back({from, edge.to, edge.weight, id, NO_ARC});
+                } else if (edge.weight < arcs_[arc].weight
+                           || (edge.weight == arcs_[arc].weight && id < arcs_[arc].first)) {
+                    arcs_[arc].weight = edge.weight;
+                    arcs_[arc].first = id;
+                }
+            }
+            for (size_t i = first_arc; i < arcs_.size(); ++i) {
+                const Arc& arc = arcs_[i];
+                arc_to[arc.to] = NO_ARC;
+                out_[from].push_back({arc.weight, arc.to, static_cast<uint32_t>(i)});
+                in_[arc.to].push_back({arc.weight, from, static_cast<uint32_t>(i)});
+            }
+        }
+        live_arc_count_ = arcs_.size();
+    }
+
+    static void RemoveLink(std::vector<UpArc>& links, uint32_t arc) {
+        const auto it = std::find_if(links.begin(), links.end(), [arc](const UpArc& link) {
+            return link.arc == arc;
+        });
+        *it = links.back();
+        links.pop_back();
+    }
+
+    // Дейкстра из from без вершины excluded до расстояния limit по путям
+    // не длиннее WITNESS_HOP_LIMIT дуг.
+    void FindWitnesses(VertexId from, VertexId excluded, double limit) {
+        witness_dist_[from] = 0.;
+        witness_hops_[from] = 0;
+        witness_touched_.push_back(from);
+        witness_queue_.clear();
+        PushQueue(witness_queue_, 0., from);
+        size_t settled = 0;
+        while (!witness_queue_.empty() && settled < WITNESS_SETTLE_LIMIT) {
+            const auto [distance, v] = PopQueue(witness_queue_);
+            if (distance > witness_dist_[v]) {
+                continue;
+            }
+            if (distance > limit) {
+                break;
+            }
+            ++settled;
+            if (witness_hops_[v] == WITNESS_HOP_LIMIT) {
+                continue;
+            }
+            for (const UpArc& link : out_[v]) {
+                const double candidate = distance + link.weight;
+                if (link.to == excluded || candidate >= witness_dist_[link.to]) {
+                    continue;
+                }
+                if (witness_dist_[link.to] == INF) {
+                    witness_touched_.push_back(link.to);
+                }
+                witness_dist_[link.to] = candidate;
+                witness_hops_[link.to] = witness_hops_[v] + 1;
+                PushQueue(witness_queue_, candidate, link.to);
+            }
+        }
+    }
+
+    void ResetWitnesses() {
+        for (VertexId v : witness_touched_) {
+            witness_dist_[v] = INF;
+        }
+        witness_touched_.clear();
+    }
+
+    // Сокращения, которые нужны при исключении v.
+    void FindShortcuts(VertexId v, std::vector<Shortcut>& shortcuts) {
+        shortcuts.clear();
+        if (out_[v].empty()) {
+            return;
+        }
+        const double max_out = std::max_element(out_[v].begin(), out_[v].end(), [](const UpArc& lhs, const UpArc& rhs) {
+                                   return lhs.weight < rhs.weight;
+                               })->weight;
+        for (const UpArc& in : in_[v]) {
+            FindWitnesses(in.to, v, in.weight + max_out);
+            for (const UpArc& out : out_[v]) {
+                const double weight = in.weight + out.weight;
+                if (out.to != in.to && witness_dist_[out.to] > weight) {
+                    shortcuts.push_back({in.to, out.to, weight, in.arc, out.arc});
+                }
+            }
+            ResetWitnesses();
+        }
+    }
+
+    // Разность числа добавляемых и удаляемых дуг плюс число уже исключённых
+    // соседей: так исключение равномерно расходится по графу. Найденные
+    // сокращения остаются в shortcuts_.
+    int GetPriority(VertexId v) {
+        FindShortcuts(v, shortcuts_);
+        return static_cast<int>(shortcuts_.size()) - static_cast<int>(out_[v].size() + in_[v].size())
+             + contracted_neighbours_[v];
+    }
+
+    // Более лёгкое сокращение заменяет дугу между теми же вершинами.
+    void AddShortcut(const Shortcut& shortcut) {
+        const uint32_t arc = static_cast<uint32_t>(arcs_.size());
+        const auto out = std::find_if(out_[shortcut.from].begin(), out_[shortcut.from].end(),
+                                      [&shortcut](const UpArc& link) {
+                                          return link.to == shortcut.to;
+                                      });
+        if (out == out_[shortcut.from].end()) {
+            out_[shortcut.from].push_back({shortcut.weight, shortcut.to, arc});
+            in_[shortcut.to].push_back({shortcut.weight, shortcut.from, arc});
+            ++live_arc_count_;
+        } else if (out->weight > shortcut.weight) {
+            auto in = std::find_if(in_[shortcut.to].begin(), in_[shortcut.to].end(), [out](const UpArc& link) {
+                return link.arc == out->arc;
+            });
+            *out = {shortcut.weight, shortcut.to, arc};
+            *in = {shortcut.weight, shortcut.from, arc};
+        } else {
+            return;
+        }
+        arcs_.push_back({shortcut.from, shortcut.to, shortcut.weight, shortcut.first, shortcut.second});
+    }
+
+    // Исключает v сокращениями из последнего GetPriority(v). Дуги v к ещё не
+    // исключённым, то есть более важным, вершинам попадают в иерархию.
+    void Contract(VertexId v) {
+        for (const Shortcut& shortcut : shortcuts_) {
+            AddShortcut(shortcut);
+        }
+        for (const UpArc& link : out_[v]) {
+            RemoveLink(in_[link.to], link.arc);
+            ++contracted_neighbours_[link.to];
+        }
+        for (const UpArc& link : in_[v]) {
+            RemoveLink(out_[link.to], link.arc);
+            ++contracted_neighbours_[link.to];
+        }
+        live_arc_count_ -= out_[v].size() + in_[v].size();
+        is_contracted_[v] = true;
+        up_out_[v] = std::move(out_[v]);
+        up_in_[v] = std::move(in_[v]);
+    }
+
+    static void BuildUpwardArcs(const std::vector<std::vector<UpArc>>& lists, std::vector<uint32_t>& offsets,
+                                std::vector<UpArc>& result) {
+        offsets.assign(1, 0);
+        result.clear();
+        for (const auto& list : lists) {
+            result.insert(result.end(), list.begin(), list.end());
+            offsets.push_back(static_cast<uint32_t>(result.size()));
+        }
+    }
+
+    Router& router_;
+    std::vector<Arc>& arcs_;
+    size_t vertex_count_;
+    std::vector<std::vector<UpArc>> out_;
+    std::vector<std::vector<UpArc>> in_;
+    std::vector<std::vector<UpArc>> up_out_;
+    std::vector<std::vector<UpArc>> up_in_;
+    std::vector<bool> is_contracted_;
+    std::vector<int> contracted_neighbours_;
+    // Число дуг между ещё не исключёнными вершинами.
+    size_t live_arc_count_ = 0;
+    std::vector<Shortcut> shortcuts_;
+    std::vector<double> witness_dist_;
+    std::vector<uint32_t> witness_hops_;
+    std::vector<VertexId> witness_touched_;
+    std::vector<QueueItem> witness_queue_;
+};
+
+Router::Router(const DirectedWeightedGraph& graph) {
+    Contraction(graph, *this).Run();
+    MarkCore();
+}
+
+Router::Router(const DirectedWeightedGraph& graph, Hierarchy hierarchy)
+    : arcs_(std::move(hierarchy.arcs))
+    , forward_offsets_(std::move(hierarchy.forward_offsets))
+    , forward_arcs_(std::move(hierarchy.forward_arcs))
+    , backward_offsets_(std::move(hierarchy.backward_offsets))
+    , backward_arcs_(std::move(hierarchy.backward_arcs))
+    , core_(std::move(hierarchy.core)) {
+    CheckHierarchy(graph);
+    MarkCore();
+}
+
+void Router::MarkCore() {
+    is_core_.assign(GetVertexCount(), false);
+    for (VertexId v : core_) {
+        is_core_[v] = true;
+    }
+}
+
+// Проверяет всё, на что полагаются запросы: границы индексов, концы дуг и
+// то, что сокращение ссылается только на более ранние дуги, поэтому
+// раскрытие пути конечно.
+void Router::CheckHierarchy(const DirectedWeightedGraph& graph) const {
+    auto check = [](bool condition) {
+        if (!condition) {
+            throw std::invalid_argument("Contraction hierarchy does not match the graph");
+        }
+    };
+    const size_t vertex_count = graph.GetVertexCount();
+    for (uint32_t i = 0; i < arcs_.size(); ++i) {
+        const Arc& arc = arcs_[i];
+        check(arc.from < vertex_count && arc.to < vertex_count);
+        if (arc.second == NO_ARC) {
+            check(arc.first < graph.GetEdgeCount());
+            const Edge& edge = graph.GetEdge(arc.first);
+            check(edge.from == arc.from && edge.to == arc.to && edge.weight == arc.weight);
+        } else {
+            check(arc.first < i && arc.second < i);
+            check(arcs_[arc.first].from == arc.from && arcs_[arc.first].to == arcs_[arc.second].from
+                  && arcs_[arc.second].to == arc.to);
+        }
+    }
+    for (const bool is_backward : {false, true}) {
+        const auto& offsets = is_backward ? backward_offsets_ : forward_offsets_;
+        const auto& up_arcs = is_backward ? backward_arcs_ : forward_arcs_;
+        check(offsets.size() == vertex_count + 1 && offsets.front() == 0 && offsets.back() == up_arcs.size());
+        for (VertexId v = 0; v < vertex_count; ++v) {
+            check(offsets[v] <= offsets[v + 1]);
+            for (uint32_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+                const UpArc& up = up_arcs[i];
+                check(up.arc < arcs_.size());
+                const Arc& arc = arcs_[up.arc];
+                check((is_backward ? arc.to == v && arc.from == up.to : arc.from == v && arc.to == up.to)
+                      && arc.weight == up.weight);
+            }
+        }
+    }
+    for (size_t i = 0; i < core_.size(); ++i) {
+        check(core_[i] < vertex_count && (i == 0 || core_[i - 1] < core_[i]));
+    }
+}
+
+std::optional<Router::RouteInfo> Router::BuildRoute(VertexId from, VertexId to) const {
+    if (from == to) {
+        return RouteInfo{};
+    }
+    SearchScratch& scratch = GetScratch(GetVertexCount());
+    scratch.Set(0, from, 0., NO_ARC);
+    scratch.Set(1, to, 0., NO_ARC);
+    PushQueue(scratch.queue[0], 0., from);
+    PushQueue(scratch.queue[1], 0., to);
+
+    double best = INF;
+    VertexId meeting = from;
+    auto relax = [&](int dir, VertexId v, double distance) {
+        const auto& offsets = dir == 0 ? forward_offsets_ : backward_offsets_;
+        const auto& up_arcs = dir == 0 ? forward_arcs_ : backward_arcs_;
+        for (uint32_t i = offsets[v]; i < offsets[v + 1]; ++i) {
+            const UpArc& up = up_arcs[i];
+            const double candidate = distance + up.weight;
+            if (candidate >= scratch.dist[dir][up.to]) {
+                continue;
+            }
+            scratch.Set(dir, up.to, candidate, up.arc);
+            PushQueue(scratch.queue[dir], candidate, up.to);
+            if (const double total = candidate + scratch.dist[1 - dir][up.to]; total < best) {
+                best = total;
+                meeting = up.to;
+            }
+        }
+    };
+
+    // Поиски идут навстречу, каждый раз продвигается тот, у кого ближе
+    // очередная вершина; путь через вершину дальше лучшего найденного уже не
+    // короче. Вершины ядра не раскрываются, а запоминаются как входы в него.
+    while (true) {
+        const double next[2] = {
+            scratch.queue[0].empty() ? INF : scratch.queue[0].front().first,
+            scratch.queue[1].empty() ? INF : scratch.queue[1].front().first,
+        };
+        if (std::min(next[0], next[1]) >= best) {
+            break;
+        }
+        const int dir = next[0] <= next[1] ? 0 : 1;
+        const auto [distance, v] = PopQueue(scratch.queue[dir]);
+        if (distance > scratch.dist[dir][v]) {
+            continue;
+        }
+        if (is_core_[v]) {
+            scratch.core_entries[dir].push_back(v);
+            continue;
+        }
+        relax(dir, v, distance);
+    }
+
+    // Внутри ядра дуги не упорядочены по важности, поэтому это обычный
+    // двусторонний Дейкстра от найденных входов: он останавливается, когда
+    // сумма расстояний до очередных вершин не меньше лучшего пути.
+    for (int dir = 0; dir < 2; ++dir) {
+        scratch.queue[dir].clear();
+        for (VertexId v : scratch.core_entries[dir]) {
+            scratch.queue[dir].emplace_back(scratch.dist[dir][v], v);
+        }
+        std::make_heap(scratch.queue[dir].begin(), scratch.queue[dir].end(), std::greater<>{});
+    }
+    while (!scratch.queue[0].empty() && !scratch.queue[1].empty()
+           && scratch.queue[0].front().first + scratch.queue[1].front().first < best) {
+        const int dir = scratch.queue[0].front().first <= scratch.queue[1].front().first ? 0 : 1;
+        const auto [distance, v] = PopQueue(scratch.queue[dir]);
+        if (distance <= scratch.dist[dir][v]) {
+            relax(dir, v, distance);
+        }
+    }
+
+    std::optional<RouteInfo> result;
+    if (best < INF) {
+        result.emplace();
+        result->weight = best;
+        std::vector<uint32_t> path;
+        for (VertexId v = meeting; scratch.parent[0][v] != NO_ARC; v = arcs_[scratch.parent[0][v]].from) {
+            path.push_back(scratch.parent[0][v]);
+        }
+        std::reverse(path.begin(), path.end());
+        for (VertexId v = meeting; scratch.parent[1][v] != NO_ARC; v = arcs_[scratch.parent[1][v]].to) {
+            path.push_back(scratch.parent[1][v]);
+        }
+        for (uint32_t arc : path) {
+            UnpackArc(arc, result->edges);
+        }
+    }
+    scratch.Reset();
+    return result;
+}
+
+Router::TargetBuckets Router::PrepareTargets(std::span<const VertexId> targets) const {
+    const size_t vertex_count = GetVertexCount();
+    SearchScratch& scratch = GetScratch(vertex_count);
+
+    // Сначала все пары (вершина, цель, расстояние), затем раскладка по вершинам подсчётом.
+    std::vector<std::pair<VertexId, std::pair<uint32_t, double>>> reached;
+    for (uint32_t target = 0; target < targets.size(); ++target) {
+        scratch.Set(1, targets[target], 0., NO_ARC);
+        PushQueue(scratch.queue[1], 0., targets[target]);
+        while (!scratch.queue[1].empty()) {
+            const auto [distance, v] = PopQueue(scratch.queue[1]);
+            if (distance > scratch.dist[1][v]) {
+                continue;
+            }
+            reached.push_back({v, {target, distance}});
+            for (uint32_t i = backward_offsets_[v]; i < backward_offsets_[v + 1]; ++i) {
+                const UpArc& up = backward_arcs_[i];
+                if (distance + up.weight < scratch.dist[1][up.to]) {
+                    scratch.Set(1, up.to, distance + up.weight, up.arc);
+                    PushQueue(scratch.queue[1], distance + up.weight, up.to);
+                }
+            }
+        }
+        scratch.Reset();
+    }
+
+    TargetBuckets result;
+    result.target_count_ = targets.size();
+    result.offsets_.assign(vertex_count + 1, 0);
+    for (const auto& [v, entry] : reached) {
+        ++result.offsets_[v + 1];
+    }
+    for (size_t v = 0; v < vertex_count; ++v) {
+        result.offsets_[v + 1] += result.offsets_[v];
+    }
+    result.entries_.resize(reached.size());
+    std::vector<uint32_t> next(result.offsets_.begin(), result.offsets_.end() - 1);
+    for (const auto& [v, entry] : reached) {
+        result.entries_[next[v]++] = entry;
+    }
+    return result;
+}
+
+void Router::FindDistances(VertexId from, const TargetBuckets& targets, std::span<double> distances) const {
+    std::fill(distances.begin(), distances.end(), INF);
+    SearchScratch& scratch = GetScratch(GetVertexCount());
+    scratch.Set(0, from, 0., NO_ARC);
+    PushQueue(scratch.queue[0], 0., from);
+    // Кратчайший путь поднимается до самой важной своей вершины или до ядра,
+    // проходит по нему и спускается к цели, поэтому достаточно встретить поиск
+    // вверх с корзинами целей: оба поиска проходят ядро целиком.
+    while (!scratch.queue[0].empty()) {
+        const auto [distance, v] = PopQueue(scratch.queue[0]);
+        if (distance > scratch.dist[0][v]) {
+            continue;
+        }
+        for (uint32_t i = targets.offsets_[v]; i < targets.offsets_[v + 1]; ++i) {
+            const auto [target, rest] = targets.entries_[i];
+            distances[target] = std::min(distances[target], distance + rest);
+        }
+        for (uint32_t i = forward_offsets_[v]; i < forward_offsets_[v + 1]; ++i) {
+            const UpArc& up = forward_arcs_[i];
+            if (distance + up.weight < scratch.dist[0][up.to]) {
+                scratch.Set(0, up.to, distance + up.weight, up.arc);
+                PushQueue(scratch.queue[0], distance + up.weight, up.to);
+            }
+        }
+    }
+    scratch.Reset();
+}
+
+void Router::UnpackArc(uint32_t arc, std::vector<EdgeId>& edges) const {
+    while (arcs_[arc].second != NO_ARC) {
+        UnpackArc(arcs_[arc].first, edges);
+        arc = arcs_[arc].second;
+    }
+    edges.push_back(arcs_[arc].first);
+}
+
+}  // namespace graph
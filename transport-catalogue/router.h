@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "graph.h"
+
+namespace graph {
+
+// Кратчайшие пути на иерархии сжатия (contraction hierarchies). При
+// построении вершины по одной исключаются из графа в порядке важности, а
+// пути через исключённую вершину заменяются рёбрами-сокращениями между её
+// соседями, если у них нет другого пути не длиннее. Когда оставшийся граф
+// становится слишком плотным, сжатие останавливается: оставшиеся вершины
+// образуют ядро. Запрос - двусторонний Дейкстра по рёбрам, ведущим к более
+// важным вершинам, а внутри ядра - по всем его рёбрам; он просматривает
+// сотни вершин вместо всего графа.
+class Router {
+public:
+    struct RouteInfo {
+        double weight = 0.;
+        // Рёбра исходного графа по порядку.
+        std::vector<EdgeId> edges;
+    };
+
+    static constexpr uint32_t NO_ARC = std::numeric_limits<uint32_t>::max();
+
+    // Ребро иерархии: для исходного first - номер ребра графа, second == NO_ARC;
+    // для сокращения first и second - две дуги, которые оно заменяет.
+    struct Arc {
+        VertexId from;
+        VertexId to;
+        double weight;
+        uint32_t first;
+        uint32_t second;
+    };
+
+    // Дуга к более важной вершине или вершине ядра to в прямом или обратном
+    // направлении. Поля упорядочены так, чтобы в структуре не было
+    // выравнивающих байтов.
+    struct UpArc {
+        double weight;
+        VertexId to;
+        uint32_t arc;
+    };
+
+    // Построенная иерархия целиком - чтобы сохранить её и не сжимать граф
+    // заново при загрузке. Дуги вершины v лежат на отрезке
+    // [offsets[v], offsets[v + 1]): в forward_arcs исходящие из v, в
+    // backward_arcs входящие в v. core - вершины ядра по возрастанию.
+    struct Hierarchy {
+        std::vector<Arc> arcs;
+        std::vector<uint32_t> forward_offsets;
+        std::vector<UpArc> forward_arcs;
+        std::vector<uint32_t> backward_offsets;
+        std::vector<UpArc> backward_arcs;
+        std::vector<VertexId> core;
+    };
+
+    explicit Router(const DirectedWeightedGraph& graph);
+
+    // Восстанавливает маршрутизатор по иерархии, построенной для того же
+    // графа. Если она не согласуется с графом, выбрасывает std::invalid_argument.
+    Router(const DirectedWeightedGraph& graph, Hierarchy hierarchy);
+
+    Hierarchy GetHierarchy() const {
+        return {arcs_, forward_offsets_, forward_arcs_, backward_offsets_, backward_arcs_, core_};
+    }
+
+    // Кратчайший путь или nullopt, если to недостижима из from. Может
+    // вызываться из нескольких потоков одновременно.
+    std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+
+    // Корзины обратных поисков от набора целей - заготовка для расстояний
+    // от многих вершин до этих целей сразу. В корзине вершины v лежат пары
+    // из номера цели и расстояния от v до неё по дугам вниз по иерархии.
+    class TargetBuckets {
+    public:
+        size_t GetTargetCount() const {
+            return target_count_;
+        }
+
+    private:
+        friend Router;
+
+        size_t target_count_ = 0;
+        std::vector<uint32_t> offsets_;
+        std::vector<std::pair<uint32_t, double>> entries_;
+    };
+
+    TargetBuckets PrepareTargets(std::span<const VertexId> targets) const;
+
+    // distances[i] - длина кратчайшего пути от from до i-й цели или
+    // бесконечность, если цель недостижима. Один поиск вверх от from
+    // вместо поиска на каждую цель; может вызываться из нескольких потоков.
+    void FindDistances(VertexId from, const TargetBuckets& targets, std::span<double> distances) const;
+
+    size_t GetVertexCount() const {
+        return forward_offsets_.size() - 1;
+    }
+
+private:
+    class Contraction;
+
+    void UnpackArc(uint32_t arc, std::vector<EdgeId>& edges) const;
+    void CheckHierarchy(const DirectedWeightedGraph& graph) const;
+    void MarkCore();
+
+    // Поля Hierarchy.
+    std::vector<Arc> arcs_;
+    std::vector<uint32_t> forward_offsets_;
+    std::vector<UpArc> forward_arcs_;
+    std::vector<uint32_t> backward_offsets_;
+    std::vector<UpArc> backward_arcs_;
+    std::vector<VertexId> core_;
+    std::vector<bool> is_core_;
+};
+
+}  // namespace graph
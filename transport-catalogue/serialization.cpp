@@ -0,0 +1,408 @@
+#include "serialization.h"
+
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace serialization {
+
+namespace {
+
+constexpr char MAGIC[8] = {'T', 'C', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr uint32_t HAS_RENDER_SETTINGS = 1;
+constexpr uint32_t HAS_ROUTING_SETTINGS = 2;
+constexpr uint32_t HAS_ROUTING_HIERARCHY = 4;
+// По хешу этой строки загрузчик проверяет, что хеши названий в снимке
+// посчитаны той же функцией, что и у него.
+constexpr std::string_view HASH_PROBE = "transport_catalogue";
+
+enum class ColorKind : uint8_t {
+    NONE,
+    NAME,
+    RGB,
+    RGBA,
+};
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::ostream& output)
+        : output_(output) {
+    }
+
+    template <typename T>
+    void Write(T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        output_.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // Записывает размер и значения подряд одним блоком.
+    template <typename T>
+    void WriteArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Write(static_cast<uint32_t>(values.size()));
+        output_.write(reinterpret_cast<const char*>(values.data()),
+                      static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    void Write(std::string_view value) {
+        Write(static_cast<uint32_t>(value.size()));
+        output_.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    void Write(const svg::Color& color) {
+        if (const auto* name = std::get_if<std::string>(&color)) {
+            Write(ColorKind::NAME);
+            Write(std::string_view(*name));
+        } else if (const auto* rgb = std::get_if<svg::Rgb>(&color)) {
+            Write(ColorKind::RGB);
+            Write(rgb->red);
+            Write(rgb->green);
+            Write(rgb->blue);
+        } else if (const auto* rgba = std::get_if<svg::Rgba>(&color)) {
+            Write(ColorKind::RGBA);
+            Write(rgba->red);
+            Write(rgba->green);
+            Write(rgba->blue);
+            Write(rgba->opacity);
+        } else {
+            Write(ColorKind::NONE);
+        }
+    }
+
+private:
+    std::ostream& output_;
+};
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::string_view data)
+        : pos_(data.data()), end_(data.data() + data.size()) {
+    }
+
+    template <typename T>
+    T Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string_view ReadString() {
+        const uint32_t size = Read<uint32_t>();
+        return {Take(size), size};
+    }
+
+    // Читает count значений подряд одним копированием.
+    template <typename T>
+    void ReadArray(std::vector<T>& values, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (count > static_cast<size_t>(end_ - pos_) / sizeof(T)) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        values.resize(count);
+        // У пустого вектора data() может быть нулевым, а memcpy его не принимает.
+        if (count != 0) {
+            std::memcpy(values.data(), Take(count * sizeof(T)), count * sizeof(T));
+        }
+    }
+
+    svg::Color ReadColor() {
+        switch (Read<ColorKind>()) {
+            case ColorKind::NONE:
+                return {};
+            case ColorKind::NAME:
+                return std::string(ReadString());
+            case ColorKind::RGB: {
+                svg::Rgb rgb;
+                rgb.red = Read<uint16_t>();
+                rgb.green = Read<uint16_t>();
+                rgb.blue = Read<uint16_t>();
+                return rgb;
+            }
+            case ColorKind::RGBA: {
+                svg::Rgba rgba;
+                rgba.red = Read<uint16_t>();
+                rgba.green = Read<uint16_t>();
+                rgba.blue = Read<uint16_t>();
+                rgba.opacity = Read<double>();
+                return rgba;
+            }
+        }
+        throw std::runtime_error("Snapshot has unknown color kind");
+    }
+
+    bool AtEnd() const {
+        return pos_ == end_;
+    }
+
+private:
+    const char* Take(size_t size) {
+        if (size > static_cast<size_t>(end_ - pos_)) {
+            throw std::runtime_error("Snapshot is truncated");
+        }
+        const char* result = pos_;
+        pos_ += size;
+        return result;
+    }
+
+    const char* pos_;
+    const char* end_;
+};
+
+void SaveMapping(const map_renderer::Mapping& mapping, SnapshotWriter& writer) {
+    writer.Write(mapping.width);
+    writer.Write(mapping.height);
+    writer.Write(mapping.padding);
+    writer.Write(mapping.line_width);
+    writer.Write(mapping.stop_radius);
+    writer.Write(static_cast<int32_t>(mapping.bus_label_font_size));
+    writer.Write(mapping.bus_label_offset.first);
+    writer.Write(mapping.bus_label_offset.second);
+    writer.Write(static_cast<int32_t>(mapping.stop_label_font_size));
+    writer.Write(mapping.stop_label_offset.first);
+    writer.Write(mapping.stop_label_offset.second);
+    writer.Write(mapping.underlayer_color);
+    writer.Write(mapping.underlayer_width);
+    writer.Write(static_cast<uint32_t>(mapping.color_palette.size()));
+    for (const auto& color : mapping.color_palette) {
+        writer.Write(color);
+    }
+}
+
+map_renderer::Mapping LoadMapping(SnapshotReader& reader) {
+    map_renderer::Mapping mapping;
+    mapping.width = reader.Read<double>();
+    mapping.height = reader.Read<double>();
+    mapping.padding = reader.Read<double>();
+    mapping.line_width = reader.Read<double>();
+    mapping.stop_radius = reader.Read<double>();
+    mapping.bus_label_font_size = reader.Read<int32_t>();
+    mapping.bus_label_offset.first = reader.Read<double>();
+    mapping.bus_label_offset.second = reader.Read<double>();
+    mapping.stop_label_font_size = reader.Read<int32_t>();
+    mapping.stop_label_offset.first = reader.Read<double>();
+    mapping.stop_label_offset.second = reader.Read<double>();
+    mapping.underlayer_color = reader.ReadColor();
+    mapping.underlayer_width = reader.Read<double>();
+    const uint32_t palette_size = reader.Read<uint32_t>();
+    for (uint32_t i = 0; i < palette_size; ++i) {
+        mapping.color_palette.push_back(reader.ReadColor());
+    }
+    return mapping;
+}
+
+void SaveHierarchy(const graph::Router::Hierarchy& hierarchy, SnapshotWriter& writer) {
+    writer.WriteArray(hierarchy.arcs);
+    writer.WriteArray(hierarchy.forward_offsets);
+    writer.WriteArray(hierarchy.forward_arcs);
+    writer.WriteArray(hierarchy.backward_offsets);
+    writer.WriteArray(hierarchy.backward_arcs);
+    writer.WriteArray(hierarchy.core);
+}
+
+// Согласованность с графом проверяет graph::Router при восстановлении.
+graph::Router::Hierarchy LoadHierarchy(SnapshotReader& reader) {
+    graph::Router::Hierarchy hierarchy;
+    reader.ReadArray(hierarchy.arcs, reader.Read<uint32_t>());
+    reader.ReadArray(hierarchy.forward_offsets, reader.Read<uint32_t>());
+    reader.ReadArray(hierarchy.forward_arcs, reader.Read<uint32_t>());
+    reader.ReadArray(hierarchy.backward_offsets, reader.Read<uint32_t>());
+    reader.ReadArray(hierarchy.backward_arcs, reader.Read<uint32_t>());
+    reader.ReadArray(hierarchy.core, reader.Read<uint32_t>());
+    return hierarchy;
+}
+
+void SaveNameIndex(const transport_catalogue::PerfectHashIndex::Table& table, SnapshotWriter& writer) {
+    writer.WriteArray(table.seeds);
+    writer.WriteArray(table.values);
+    writer.Write(static_cast<uint8_t>(table.is_fallback));
+}
+
+transport_catalogue::PerfectHashIndex::Table LoadNameIndex(SnapshotReader& reader) {
+    transport_catalogue::PerfectHashIndex::Table table;
+    reader.ReadArray(table.seeds, reader.Read<uint32_t>());
+    reader.ReadArray(table.values, reader.Read<uint32_t>());
+    table.is_fallback = reader.Read<uint8_t>() != 0;
+    return table;
+}
+
+// BusStat пишется по полям: в структуре есть выравнивание.
+void SaveBusStats(const std::vector<transport_catalogue::BusStat>& stats, SnapshotWriter& writer) {
+    writer.Write(static_cast<uint32_t>(stats.size()));
+    for (const auto& stat : stats) {
+        writer.Write(static_cast<uint8_t>(stat.has_road_distances));
+        writer.Write(static_cast<int32_t>(stat.stop_count));
+        writer.Write(static_cast<int32_t>(stat.unique_stop_count));
+        writer.Write(static_cast<int32_t>(stat.route_length));
+        writer.Write(stat.geo_length);
+        writer.Write(stat.curvature);
+    }
+}
+
+std::vector<transport_catalogue::BusStat> LoadBusStats(SnapshotReader& reader) {
+    std::vector<transport_catalogue::BusStat> stats(reader.Read<uint32_t>());
+    for (auto& stat : stats) {
+        stat.has_road_distances = reader.Read<uint8_t>() != 0;
+        stat.stop_count = reader.Read<int32_t>();
+        stat.unique_stop_count = reader.Read<int32_t>();
+        stat.route_length = reader.Read<int32_t>();
+        stat.geo_length = reader.Read<double>();
+        stat.curvature = reader.Read<double>();
+    }
+    return stats;
+}
+
+void SaveCatalogue(const transport_catalogue::TransportCatalogue::FrozenData& data, SnapshotWriter& writer) {
+    writer.WriteArray(data.names.chars);
+    writer.WriteArray(data.names.name_ends);
+    writer.WriteArray(data.names.hashes);
+    writer.WriteArray(data.names.slots);
+    writer.WriteArray(data.stop_names);
+    writer.WriteArray(data.stop_coords);
+    writer.WriteArray(data.stop_trig.sin_lat);
+    writer.WriteArray(data.stop_trig.cos_lat);
+    writer.WriteArray(data.stop_trig.sin_lng);
+    writer.WriteArray(data.stop_trig.cos_lng);
+    writer.WriteArray(data.stop_spatial_index.flat_coords);
+    writer.WriteArray(data.stop_spatial_index.flat_ids);
+    writer.WriteArray(data.stop_spatial_index.sphere_xyz);
+    writer.WriteArray(data.stop_spatial_index.sphere_ids);
+    writer.WriteArray(data.bus_names);
+    writer.WriteArray(data.bus_is_roundtrip);
+    writer.WriteArray(data.route_offsets);
+    writer.WriteArray(data.route_stops);
+    writer.WriteArray(data.road_distances);
+    writer.WriteArray(data.distance_offsets);
+    writer.WriteArray(data.distance_targets);
+    writer.WriteArray(data.distance_values);
+    writer.WriteArray(data.route_distances);
+    writer.WriteArray(data.route_link_offsets);
+    writer.WriteArray(data.route_links);
+    SaveBusStats(data.bus_stats, writer);
+    writer.WriteArray(data.stop_bus_offsets);
+    writer.WriteArray(data.stop_buses);
+    SaveNameIndex(data.stop_index, writer);
+    SaveNameIndex(data.bus_index, writer);
+}
+
+// Согласованность массивов проверяет TransportCatalogue::Restore.
+transport_catalogue::TransportCatalogue::FrozenData LoadCatalogue(SnapshotReader& reader) {
+    transport_catalogue::TransportCatalogue::FrozenData data;
+    reader.ReadArray(data.names.chars, reader.Read<uint32_t>());
+    reader.ReadArray(data.names.name_ends, reader.Read<uint32_t>());
+    reader.ReadArray(data.names.hashes, reader.Read<uint32_t>());
+    reader.ReadArray(data.names.slots, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_names, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_coords, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_trig.sin_lat, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_trig.cos_lat, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_trig.sin_lng, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_trig.cos_lng, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_spatial_index.flat_coords, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_spatial_index.flat_ids, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_spatial_index.sphere_xyz, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_spatial_index.sphere_ids, reader.Read<uint32_t>());
+    reader.ReadArray(data.bus_names, reader.Read<uint32_t>());
+    reader.ReadArray(data.bus_is_roundtrip, reader.Read<uint32_t>());
+    reader.ReadArray(data.route_offsets, reader.Read<uint32_t>());
+    reader.ReadArray(data.route_stops, reader.Read<uint32_t>());
+    reader.ReadArray(data.road_distances, reader.Read<uint32_t>());
+    reader.ReadArray(data.distance_offsets, reader.Read<uint32_t>());
+    reader.ReadArray(data.distance_targets, reader.Read<uint32_t>());
+    reader.ReadArray(data.distance_values, reader.Read<uint32_t>());
+    reader.ReadArray(data.route_distances, reader.Read<uint32_t>());
+    reader.ReadArray(data.route_link_offsets, reader.Read<uint32_t>());
+    reader.ReadArray(data.route_links, reader.Read<uint32_t>());
+    data.bus_stats = LoadBusStats(reader);
+    reader.ReadArray(data.stop_bus_offsets, reader.Read<uint32_t>());
+    reader.ReadArray(data.stop_buses, reader.Read<uint32_t>());
+    data.stop_index = LoadNameIndex(reader);
+    data.bus_index = LoadNameIndex(reader);
+    return data;
+}
+
+}  // namespace
+
+bool IsSnapshot(std::string_view data) {
+    return data.size() >= sizeof(MAGIC) && std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+void SaveSnapshot(const transport_catalogue::TransportCatalogue& catalogue,
+                  const SnapshotSettings& settings, std::ostream& output) {
+    SnapshotWriter writer(output);
+    output.write(MAGIC, sizeof(MAGIC));
+    writer.Write(BYTE_ORDER_MARK);
+    writer.Write(SNAPSHOT_VERSION);
+    const bool has_hierarchy = settings.routing_settings && settings.routing_hierarchy;
+    writer.Write((settings.render_settings ? HAS_RENDER_SETTINGS : 0u)
+                 | (settings.routing_settings ? HAS_ROUTING_SETTINGS : 0u)
+                 | (has_hierarchy ? HAS_ROUTING_HIERARCHY : 0u));
+
+    writer.Write(static_cast<uint64_t>(transport_catalogue::NamePool::Hash(HASH_PROBE)));
+    SaveCatalogue(catalogue.GetFrozenData(), writer);
+
+    if (settings.render_settings) {
+        SaveMapping(*settings.render_settings, writer);
+    }
+    if (settings.routing_settings) {
+        writer.Write(static_cast<int32_t>(settings.routing_settings->bus_wait_time));
+        writer.Write(settings.routing_settings->bus_velocity);
+    }
+    if (has_hierarchy) {
+        SaveHierarchy(*settings.routing_hierarchy, writer);
+    }
+    if (!output) {
+        throw std::runtime_error("Failed to write snapshot");
+    }
+}
+
+SnapshotSettings LoadSnapshot(std::string_view data, transport_catalogue::TransportCatalogue& catalogue) {
+    if (!IsSnapshot(data)) {
+        throw std::runtime_error("Not a transport catalogue snapshot");
+    }
+    SnapshotReader reader(data.substr(sizeof(MAGIC)));
+    if (reader.Read<uint32_t>() != BYTE_ORDER_MARK) {
+        throw std::runtime_error("Snapshot was written with a different byte order");
+    }
+    if (const uint32_t version = reader.Read<uint32_t>(); version != SNAPSHOT_VERSION) {
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(version));
+    }
+    const uint32_t flags = reader.Read<uint32_t>();
+    if (reader.Read<uint64_t>() != transport_catalogue::NamePool::Hash(HASH_PROBE)) {
+        throw std::runtime_error("Snapshot was written with a different name hash function");
+    }
+    auto frozen = LoadCatalogue(reader);
+
+    SnapshotSettings settings;
+    if (flags & HAS_RENDER_SETTINGS) {
+        settings.render_settings = LoadMapping(reader);
+    }
+    if (flags & HAS_ROUTING_SETTINGS) {
+        transport_router::RoutingSettings routing;
+        routing.bus_wait_time = reader.Read<int32_t>();
+        routing.bus_velocity = reader.Read<double>();
+        settings.routing_settings = routing;
+    }
+    if ((flags & HAS_ROUTING_HIERARCHY) && (flags & HAS_ROUTING_SETTINGS)) {
+        settings.routing_hierarchy = LoadHierarchy(reader);
+    }
+    if (!reader.AtEnd()) {
+        throw std::runtime_error("Snapshot has trailing data");
+    }
+    try {
+        if (settings.routing_settings) {
+            transport_router::CheckRoutingSettings(*settings.routing_settings);
+        }
+        catalogue.Restore(std::move(frozen));
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error(std::string("Snapshot is corrupt: ") + e.what());
+    }
+    return settings;
+}
+
+}  // namespace serialization
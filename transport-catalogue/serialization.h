@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string_view>
+
+#include "map_renderer.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+namespace serialization {
+
+// Двоичный снимок справочника: заголовок с сигнатурой и версией, затем
+// замороженный справочник вместе с индексами (TransportCatalogue::FrozenData)
+// и, если заданы, настройки отрисовки и маршрутизации с иерархией сжатия
+// графа маршрутов. Числа и хеши названий записываются так, как они лежат в
+// памяти; загрузчик проверяет порядок байтов и функцию хеширования по меткам
+// в заголовке и читает только снимки своей версии.
+inline constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+// Настройки, сохранённые в снимке вместе со справочником.
+struct SnapshotSettings {
+    std::optional<map_renderer::Mapping> render_settings;
+    std::optional<transport_router::RoutingSettings> routing_settings;
+    // TransportRouter::GetHierarchy для routing_settings; без них не записывается.
+    std::optional<graph::Router::Hierarchy> routing_hierarchy;
+};
+
+// Проверяет сигнатуру в начале данных.
+bool IsSnapshot(std::string_view data);
+
+// Записывает замороженный справочник и заданные настройки. Для незамороженного
+// справочника выбрасывает std::logic_error.
+void SaveSnapshot(const transport_catalogue::TransportCatalogue& catalogue,
+                  const SnapshotSettings& settings, std::ostream& output);
+
+// Заменяет содержимое справочника снимком; индексы не перестраиваются, и
+// справочник сразу заморожен. Возвращает сохранённые настройки. При
+// повреждённом или чужом снимке, в том числе с номерами остановок вне
+// диапазона, выбрасывает std::runtime_error, и справочник не меняется.
+SnapshotSettings LoadSnapshot(std::string_view data, transport_catalogue::TransportCatalogue& catalogue);
+
+}  // namespace serialization
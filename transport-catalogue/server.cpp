@@ -0,0 +1,253 @@
+#include "server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace server {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Буфер потока поверх сокета. Запись идёт через send с MSG_NOSIGNAL, чтобы
+// отключившийся клиент не завершал процесс сигналом SIGPIPE.
+class SocketStreamBuf final : public std::streambuf {
+public:
+    explicit SocketStreamBuf(int fd)
+        : fd_(fd) {
+        setg(input_, input_, input_);
+        setp(output_, output_ + sizeof(output_));
+    }
+
+    ~SocketStreamBuf() override {
+        Flush();
+    }
+
+protected:
+    int_type underflow() override {
+        ssize_t size;
+        do {
+            size = ::read(fd_, input_, sizeof(input_));
+        } while (size < 0 && errno == EINTR);
+        if (size <= 0) {
+            return traits_type::eof();
+        }
+        setg(input_, input_, input_ + size);
+        return traits_type::to_int_type(input_[0]);
+    }
+
+    int_type overflow(int_type ch) override {
+        if (!Flush()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override {
+        return Flush() ? 0 : -1;
+    }
+
+private:
+    bool Flush() {
+        const char* data = pbase();
+        size_t size = static_cast<size_t>(pptr() - pbase());
+        while (size > 0) {
+            const ssize_t written = ::send(fd_, data, size, MSG_NOSIGNAL);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+        setp(output_, output_ + sizeof(output_));
+        return true;
+    }
+
+    int fd_;
+    char input_[1 << 16];
+    char output_[1 << 16];
+};
+
+// Закрывает дескриптор при выходе из области видимости.
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd)
+        : fd_(fd) {
+    }
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    ~FileDescriptor() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    int Get() const {
+        return fd_;
+    }
+
+private:
+    int fd_;
+};
+
+// Ответ на запрос пакета, который не удалось выполнить: ошибка одного запроса
+// не мешает остальным.
+std::string MakeErrorAnswer(const json::Node& request, std::string_view message) {
+    std::ostringstream answer;
+    json::Writer writer(answer);
+    writer.StartDict().Key("error_message"sv).Value(message);
+    if (request.IsMap() && request.AsMap().count("id"s) != 0) {
+        writer.Key("request_id"sv).Value(request.AsMap().at("id"s));
+    }
+    writer.EndDict();
+    return std::move(answer).str();
+}
+
+std::runtime_error SystemError(const std::string& what) {
+    return std::runtime_error(what + ": "s + std::strerror(errno));
+}
+
+}  // namespace
+
+void Server::Serve(std::istream& input, std::ostream& output) {
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.find_first_not_of(" \t\r"sv) == std::string::npos) {
+            continue;
+        }
+        ++batch_count_;
+        try {
+            ServeBatch(line, output);
+        } catch (const std::exception& e) {
+            json::Writer(output).StartDict().Key("error_message"sv).Value(std::string_view(e.what())).EndDict();
+            log_ << "batch "sv << batch_count_ << ": failed: "sv << e.what() << '\n';
+        }
+        output << '\n';
+        output.flush();
+        log_.flush();
+        if (!output) {
+            return;
+        }
+    }
+}
+
+void Server::ServeBatch(std::string_view line, std::ostream& output) {
+    const Clock::time_point batch_start = Clock::now();
+    const json::Document document = json::Load(line);
+    const json::Node& root = document.GetRoot();
+
+    const json::Array* requests = nullptr;
+    const map_renderer::Mapping* mapping = mapping_;
+    std::optional<map_renderer::Mapping> batch_mapping;
+    if (root.IsArray()) {
+        requests = &root.AsArray();
+    } else {
+        const json::Dict& sections = root.AsMap();
+        requests = &sections.at("stat_requests"s).AsArray();
+        if (sections.count("render_settings"s) != 0) {
+            batch_mapping = map_renderer::RenderSettings(sections.at("render_settings"s).AsMap());
+            mapping = &*batch_mapping;
+        }
+    }
+
+    // Каждый ответ отправляется, как только готовы он и все предыдущие.
+    json::Writer writer(output);
+    std::vector<double> latencies(requests->size());
+    writer.StartArray();
+    reader_.GetExecutor().Run(requests->size(),
+        [&](size_t i) {
+            const Clock::time_point start = Clock::now();
+            const json::Node& request = (*requests)[i];
+            std::string answer;
+            try {
+                const json::Dict& fields = request.AsMap();
+                if (mapping == nullptr && fields.at("type"s).AsString() == "Map"sv) {
+                    answer = MakeErrorAnswer(request, "render_settings are missing"sv);
+                } else {
+                    static const map_renderer::Mapping NO_MAPPING{};
+                    answer = reader_.StatRequest(fields, mapping != nullptr ? *mapping : NO_MAPPING);
+                }
+            } catch (const std::exception& e) {
+                answer = MakeErrorAnswer(request, e.what());
+            }
+            latencies[i] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            return answer;
+        },
+        [&](const std::string& answer) {
+            writer.RawValue(answer);
+            output.flush();
+        });
+    writer.EndArray();
+
+    const double elapsed = std::chrono::duration<double>(Clock::now() - batch_start).count();
+    double p99 = 0.;
+    if (!latencies.empty()) {
+        const auto nth = latencies.begin() + (latencies.size() * 99 + 99) / 100 - 1;
+        std::nth_element(latencies.begin(), nth, latencies.end());
+        p99 = *nth;
+    }
+    log_ << "batch "sv << batch_count_ << ": "sv << latencies.size() << " requests in "sv
+         << std::fixed << std::setprecision(3) << elapsed * 1000. << " ms, "sv
+         << std::setprecision(0) << (elapsed > 0. ? latencies.size() / elapsed : 0.) << " req/s, p99 "sv
+         << std::setprecision(1) << p99 << " us\n"sv << std::defaultfloat;
+}
+
+void Server::ServeSocket(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.data(), path.size());
+
+    const FileDescriptor listener(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (listener.Get() < 0) {
+        throw SystemError("socket");
+    }
+    ::unlink(path.c_str());
+    if (::bind(listener.Get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+        throw SystemError("bind " + path);
+    }
+    if (::listen(listener.Get(), SOMAXCONN) < 0) {
+        throw SystemError("listen " + path);
+    }
+    log_ << "listening on "sv << path << std::endl;
+
+    while (true) {
+        const FileDescriptor client(::accept(listener.Get(), nullptr, nullptr));
+        if (client.Get() < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw SystemError("accept");
+        }
+        SocketStreamBuf buffer(client.Get());
+        std::istream input(&buffer);
+        std::ostream output(&buffer);
+        Serve(input, output);
+    }
+}
+
+}  // namespace server
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+#include "json_reader.h"
+#include "map_renderer.h"
+
+namespace server {
+
+// Обслуживает пакеты stat_requests к уже загруженному справочнику. Пакет -
+// одна строка JSON: массив запросов или словарь с разделом stat_requests и,
+// при необходимости, своими render_settings. На каждый пакет выводится одна
+// строка с массивом ответов; ответ отправляется, как только готовы он и все
+// предыдущие. Запрос, который не удалось выполнить (например, Map без
+// настроек отрисовки), получает свой ответ с error_message. В журнал пишутся
+// число запросов, пропускная способность и 99-й перцентиль задержки одного
+// запроса.
+class Server {
+public:
+    // mapping используется для пакетов без render_settings и может быть nullptr.
+    Server(json_reader::JSONReader& reader, const map_renderer::Mapping* mapping, std::ostream& log)
+        : reader_(reader), mapping_(mapping), log_(log) {
+    }
+
+    // Читает пакеты из input до конца потока.
+    void Serve(std::istream& input, std::ostream& output);
+
+    // Принимает соединения на Unix-сокете path и обслуживает их по очереди.
+    // Возвращает управление только при ошибке сокета (std::runtime_error).
+    void ServeSocket(const std::string& path);
+
+private:
+    void ServeBatch(std::string_view line, std::ostream& output);
+
+    json_reader::JSONReader& reader_;
+    const map_renderer::Mapping* mapping_;
+    std::ostream& log_;
+    size_t batch_count_ = 0;
+};
+
+}  // namespace server
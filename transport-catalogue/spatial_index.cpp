@@ -0,0 +1,190 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <stdexcept>
+
+namespace transport_catalogue {
+
+namespace {
+
+void ToSphere(geo::Coordinates coord, double (&xyz)[3]) {
+    const double lat = coord.lat * geo::DEGREES_TO_RADIANS;
+    const double lng = coord.lng * geo::DEGREES_TO_RADIANS;
+    xyz[0] = std::cos(lat) * std::cos(lng);
+    xyz[1] = std::cos(lat) * std::sin(lng);
+    xyz[2] = std::sin(lat);
+}
+
+}  // namespace
+
+void SpatialIndex::Build(std::span<const geo::Coordinates> coords) {
+    flat_.clear();
+    sphere_.clear();
+    flat_.reserve(coords.size());
+    sphere_.reserve(coords.size());
+    for (uint32_t id = 0; id < coords.size(); ++id) {
+        flat_.push_back({coords[id].lat, coords[id].lng, id});
+        SpherePoint point;
+        ToSphere(coords[id], point.xyz);
+        point.id = id;
+        sphere_.push_back(point);
+    }
+    BuildFlat(flat_, 0);
+    BuildSphere(sphere_, 0);
+}
+
+SpatialIndex::Contents SpatialIndex::GetContents() const {
+    Contents contents;
+    for (const FlatPoint& point : flat_) {
+        contents.flat_coords.push_back({point.lat, point.lng});
+        contents.flat_ids.push_back(point.id);
+    }
+    for (const SpherePoint& point : sphere_) {
+        contents.sphere_xyz.insert(contents.sphere_xyz.end(), std::begin(point.xyz), std::end(point.xyz));
+        contents.sphere_ids.push_back(point.id);
+    }
+    return contents;
+}
+
+void SpatialIndex::Restore(Contents contents, size_t point_count) {
+    const auto is_valid_id = [point_count](uint32_t id) {
+        return id < point_count;
+    };
+    if (contents.flat_coords.size() != point_count || contents.flat_ids.size() != point_count
+        || contents.sphere_ids.size() != point_count || contents.sphere_xyz.size() != point_count * 3
+        || !std::all_of(contents.flat_ids.begin(), contents.flat_ids.end(), is_valid_id)
+        || !std::all_of(contents.sphere_ids.begin(), contents.sphere_ids.end(), is_valid_id)) {
+        throw std::invalid_argument("Spatial index contents are inconsistent");
+    }
+    flat_.clear();
+    sphere_.clear();
+    flat_.reserve(point_count);
+    sphere_.reserve(point_count);
+    for (size_t i = 0; i < point_count; ++i) {
+        flat_.push_back({contents.flat_coords[i].lat, contents.flat_coords[i].lng, contents.flat_ids[i]});
+        SpherePoint point;
+        std::copy_n(contents.sphere_xyz.begin() + i * 3, 3, point.xyz);
+        point.id = contents.sphere_ids[i];
+        sphere_.push_back(point);
+    }
+}
+
+void SpatialIndex::BuildFlat(std::span<FlatPoint> points, int axis) {
+    if (points.size() <= 1) {
+        return;
+    }
+    const size_t mid = points.size() / 2;
+    std::nth_element(points.begin(), points.begin() + mid, points.end(),
+                     [axis](const FlatPoint& lhs, const FlatPoint& rhs) {
+                         return axis == 0 ? lhs.lat < rhs.lat : lhs.lng < rhs.lng;
+                     });
+    BuildFlat(points.first(mid), axis ^ 1);
+    BuildFlat(points.subspan(mid + 1), axis ^ 1);
+}
+
+void SpatialIndex::BuildSphere(std::span<SpherePoint> points, int axis) {
+    if (points.size() <= 1) {
+        return;
+    }
+    const size_t mid = points.size() / 2;
+    std::nth_element(points.begin(), points.begin() + mid, points.end(),
+                     [axis](const SpherePoint& lhs, const SpherePoint& rhs) {
+                         return lhs.xyz[axis] < rhs.xyz[axis];
+                     });
+    BuildSphere(points.first(mid), (axis + 1) % 3);
+    BuildSphere(points.subspan(mid + 1), (axis + 1) % 3);
+}
+
+std::vector<uint32_t> SpatialIndex::FindInBox(geo::Coordinates min, geo::Coordinates max) const {
+    std::vector<uint32_t> result;
+    if (min.lat <= max.lat && min.lng <= max.lng) {
+        FindInBox(0, flat_.size(), 0, min, max, result);
+    }
+    return result;
+}
+
+void SpatialIndex::FindInBox(size_t begin, size_t end, int axis, geo::Coordinates min, geo::Coordinates max,
+                             std::vector<uint32_t>& result) const {
+    while (begin < end) {
+        const size_t mid = begin + (end - begin) / 2;
+        const FlatPoint& point = flat_[mid];
+        if (min.lat <= point.lat && point.lat <= max.lat && min.lng <= point.lng && point.lng <= max.lng) {
+            result.push_back(point.id);
+        }
+        const double value = axis == 0 ? point.lat : point.lng;
+        const bool go_left = (axis == 0 ? min.lat : min.lng) <= value;
+        const bool go_right = value <= (axis == 0 ? max.lat : max.lng);
+        axis ^= 1;
+        if (go_left && go_right) {
+            FindInBox(begin, mid, axis, min, max, result);
+            begin = mid + 1;
+        } else if (go_left) {
+            end = mid;
+        } else {
+            begin = mid + 1;
+        }
+    }
+}
+
+std::vector<std::pair<uint32_t, double>> SpatialIndex::FindNearest(geo::Coordinates point, size_t count) const {
+    std::vector<Candidate> heap;
+    count = std::min(count, sphere_.size());
+    if (count != 0) {
+        double query[3];
+        ToSphere(point, query);
+        heap.reserve(count);
+        FindNearest(0, sphere_.size(), 0, query, count, heap);
+    }
+    std::sort_heap(heap.begin(), heap.end());
+
+    std::vector<std::pair<uint32_t, double>> result;
+    result.reserve(heap.size());
+    for (const auto& [chord2, id] : heap) {
+        const double half_chord = std::min(std::sqrt(chord2) / 2., 1.);
+        result.emplace_back(id, 2. * std::asin(half_chord) * geo::EARTH_RADIUS);
+    }
+    return result;
+}
+
+void SpatialIndex::FindNearest(size_t begin, size_t end, int axis, const double (&query)[3], size_t count,
+                               std::vector<Candidate>& heap) const {
+    if (begin >= end) {
+        return;
+    }
+    const size_t mid = begin + (end - begin) / 2;
+    const SpherePoint& point = sphere_[mid];
+    double chord2 = 0.;
+    for (int i = 0; i < 3; ++i) {
+        chord2 += (point.xyz[i] - query[i]) * (point.xyz[i] - query[i]);
+    }
+    const Candidate candidate{chord2, point.id};
+    if (heap.size() < count) {
+        heap.push_back(candidate);
+        std::push_heap(heap.begin(), heap.end());
+    } else if (candidate < heap.front()) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = candidate;
+        std::push_heap(heap.begin(), heap.end());
+    }
+
+    const double diff = query[axis] - point.xyz[axis];
+    const int next_axis = (axis + 1) % 3;
+    const bool is_left_near = diff <= 0.;
+    if (is_left_near) {
+        FindNearest(begin, mid, next_axis, query, count, heap);
+    } else {
+        FindNearest(mid + 1, end, next_axis, query, count, heap);
+    }
+    // По ту сторону плоскости все точки не ближе, чем сама плоскость.
+    if (heap.size() < count || diff * diff <= heap.front().chord2) {
+        if (is_left_near) {
+            FindNearest(mid + 1, end, next_axis, query, count, heap);
+        } else {
+            FindNearest(begin, mid, next_axis, query, count, heap);
+        }
+    }
+}
+
+}  // namespace transport_catalogue
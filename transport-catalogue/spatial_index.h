@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "geo.h"
+
+namespace transport_catalogue {
+
+// Пространственный индекс над неизменяемым набором точек из двух неявных
+// k-d деревьев. Для поиска в прямоугольнике дерево строится по широте и
+// долготе. Для поиска ближайших - по точкам единичной сферы: длина хорды
+// монотонно зависит от расстояния по дуге, поэтому отсечение по разделяющей
+// плоскости точное и не ломается на 180-м меридиане и у полюсов.
+class SpatialIndex {
+public:
+    void Build(std::span<const geo::Coordinates> coords);
+
+    // Индексы точек внутри прямоугольника, границы включаются; порядок произвольный.
+    // Прямоугольник через 180-й меридиан не поддерживается: при min.lng > max.lng
+    // результат пуст.
+    std::vector<uint32_t> FindInBox(geo::Coordinates min, geo::Coordinates max) const;
+
+    // Не больше count ближайших к point точек: пары из индекса и расстояния по
+    // дуге в метрах, ближние первыми, при равенстве - с меньшим индексом.
+    std::vector<std::pair<uint32_t, double>> FindNearest(geo::Coordinates point, size_t count) const;
+
+    // Узлы обоих деревьев по столбцам в порядке хранения; у точек сферы
+    // по три координаты подряд.
+    struct Contents {
+        std::vector<geo::Coordinates> flat_coords;
+        std::vector<uint32_t> flat_ids;
+        std::vector<double> sphere_xyz;
+        std::vector<uint32_t> sphere_ids;
+    };
+
+    Contents GetContents() const;
+
+    // Заменяет индекс сохранённым через GetContents для point_count точек.
+    // Выбрасывает std::invalid_argument при несовпадении размеров или индексе
+    // точки вне диапазона.
+    void Restore(Contents contents, size_t point_count);
+
+private:
+    struct FlatPoint {
+        double lat;
+        double lng;
+        uint32_t id;
+    };
+
+    struct SpherePoint {
+        double xyz[3];
+        uint32_t id;
+    };
+
+    struct Candidate {
+        double chord2;
+        uint32_t id;
+
+        bool operator<(const Candidate& other) const {
+            return chord2 < other.chord2 || (chord2 == other.chord2 && id < other.id);
+        }
+    };
+
+    static void BuildFlat(std::span<FlatPoint> points, int axis);
+    static void BuildSphere(std::span<SpherePoint> points, int axis);
+
+    void FindInBox(size_t begin, size_t end, int axis, geo::Coordinates min, geo::Coordinates max,
+                   std::vector<uint32_t>& result) const;
+    void FindNearest(size_t begin, size_t end, int axis, const double (&query)[3], size_t count,
+                     std::vector<Candidate>& heap) const;
+
+    // Узел поддерева [begin, end) - его середина, левее неё координата по оси
+    // axis не больше, правее - не меньше; ось чередуется с глубиной.
+    std::vector<FlatPoint> flat_;
+    std::vector<SpherePoint> sphere_;
+};
+
+}  // namespace transport_catalogue
@@ -1,43 +1,160 @@
 #include "svg.h"
 
+#include <algorithm>
+#include <charconv>
+
 namespace svg {
 
 using namespace std::literals;
 
-std::ostream& operator<<(std::ostream& output, StrokeLineCap cap) {
+namespace {
+
+std::string_view ToString(StrokeLineCap cap) {
     switch (cap) {
         case StrokeLineCap::BUTT:
-            output << "butt"s;
-            break;
+            return "butt"sv;
         case StrokeLineCap::ROUND:
-            output << "round"s;
-            break;
+            return "round"sv;
         case StrokeLineCap::SQUARE:
-            output << "square"s;
-            break;
+            return "square"sv;
     }
-    return output;
+    return {};
 }
 
-std::ostream& operator<<(std::ostream& output, StrokeLineJoin join) {
+std::string_view ToString(StrokeLineJoin join) {
     switch (join) {
         case StrokeLineJoin::ARCS:
-            output << "arcs"s;
-            break;
+            return "arcs"sv;
         case StrokeLineJoin::BEVEL:
-            output << "bevel"s;
-            break;
+            return "bevel"sv;
         case StrokeLineJoin::MITER:
-            output << "miter"s;
-            break;
+            return "miter"sv;
         case StrokeLineJoin::MITER_CLIP:
-            output << "miter-clip"s;
-            break;
+            return "miter-clip"sv;
         case StrokeLineJoin::ROUND:
-            output << "round"s;
-            break;
+            return "round"sv;
+    }
+    return {};
+}
+
+void AppendEscaped(std::string& out, std::string_view text) {
+    for (const char c : text) {
+        switch (c) {
+            case '&':
+                out += "&amp;"sv;
+                break;
+            case '"':
+                out += "&quot;"sv;
+                break;
+            case '\'':
+                out += "&apos;"sv;
+                break;
+            case '<':
+                out += "&lt;"sv;
+                break;
+            case '>':
+                out += "&gt;"sv;
+                break;
+            default:
+                out += c;
+        }
+    }
+}
+
+void RenderCircle(OutputBuffer& out, Point center, double radius) {
+    out << "<circle cx=\""sv << center.x << "\" cy=\""sv << center.y << "\" "sv;
+    out << "r=\""sv << radius << "\""sv;
+}
+
+void RenderTextPosition(OutputBuffer& out, Point pos, Point offset, uint32_t font_size,
+                        const std::string& font_family, const std::string& font_weight) {
+    out << " x=\""sv << pos.x << "\" y=\""sv << pos.y << "\"";
+    out << " dx=\""sv << offset.x << "\" dy=\""sv << offset.y << "\"";
+    out << " font-size=\""sv << font_size << "\"";
+    if (!font_family.empty()){
+        out << " font-family=\""sv << font_family << "\"";
+    }
+    if (!font_weight.empty()){
+        out << " font-weight=\""sv << font_weight << "\"";
     }
-    return output;
+}
+
+void RenderHeader(OutputBuffer& out) {
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"sv;
+    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">\n"sv;
+}
+
+template <typename... Args>
+void AppendChars(std::string& data, Args... args) {
+    char buffer[32];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), args...);
+    data.append(buffer, result.ptr);
+}
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& output, StrokeLineCap cap) {
+    return output << ToString(cap);
+}
+
+std::ostream& operator<<(std::ostream& output, StrokeLineJoin join) {
+    return output << ToString(join);
+}
+
+OutputBuffer& OutputBuffer::operator<<(int value) {
+    AppendChars(data_, value);
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(unsigned value) {
+    AppendChars(data_, value);
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(double value) {
+    AppendChars(data_, value, std::chars_format::general, 6);
+    return *this;
+}
+
+OutputBuffer& OutputBuffer::operator<<(const Color& color) {
+    if (const auto* name = std::get_if<std::string>(&color)) {
+        return *this << *name;
+    }
+    if (const auto* rgb = std::get_if<Rgb>(&color)) {
+        return *this << "rgb("sv << rgb->red << ','
+                     << rgb->green << ',' << rgb->blue << ')';
+    }
+    if (const auto* rgba = std::get_if<Rgba>(&color)) {
+        return *this << "rgba("sv << rgba->red << ',' << rgba->green << ','
+                     << rgba->blue << ',' << rgba->opacity << ')';
+    }
+    return *this << "none"sv;
+}
+
+void PathAttrs::Render(OutputBuffer& out) const {
+    if (fill_color) {
+        out << " fill=\""sv << *fill_color << "\""sv;
+    }
+    if (stroke_color) {
+        out << " stroke=\""sv << *stroke_color << "\""sv;
+    }
+    if (stroke_width) {
+        out << " stroke-width=\""sv << *stroke_width << "\""sv;
+    }
+    if (stroke_line_cap) {
+        out << " stroke-linecap=\""sv << *stroke_line_cap << "\""sv;
+    }
+    if (stroke_line_join) {
+        out << " stroke-linejoin=\""sv << *stroke_line_join << "\""sv;
+    }
+}
+
+OutputBuffer& OutputBuffer::operator<<(StrokeLineCap cap) {
+    return *this << ToString(cap);
+}
+
+OutputBuffer& OutputBuffer::operator<<(StrokeLineJoin join) {
+    return *this << ToString(join);
 }
     
 void Object::Render(const RenderContext& context) const {
@@ -45,7 +162,7 @@ void Object::Render(const RenderContext& context) const {
 
     RenderObject(context);
 
-    context.out << std::endl;
+    context.out << '\n';
 }
 
 Circle& Circle::SetCenter(Point center)  {
@@ -60,8 +177,7 @@ Circle& Circle::SetRadius(double radius)  {
 
 void Circle::RenderObject(const RenderContext& context) const {
     auto& out = context.out;
-    out << "<circle cx=\""sv << center_.x << "\" cy=\""sv << center_.y << "\" "sv;
-    out << "r=\""sv << radius_ << "\""sv;
+    RenderCircle(out, center_, radius_);
     RenderAttrs(context.out);
     out << "/>"sv;
 }
@@ -113,11 +229,9 @@ Text& Text::SetFontWeight(std::string font_weight) {
 }
     
 Text& Text::SetData(std::string data) {
-    data_ = std::regex_replace(data, std::regex("&"s), "&amp;"s);
-    data_ = std::regex_replace(data_, std::regex("\""s), "&quot;"s);
-    data_ = std::regex_replace(data_, std::regex("\'"s), "&apos;"s);
-    data_ = std::regex_replace(data_, std::regex("<"s), "&lt;"s);
-    data_ = std::regex_replace(data_, std::regex(">"s), "&gt;"s);
+    data_.clear();
+    data_.reserve(data.size());
+    AppendEscaped(data_, data);
     return *this;
 }
     
@@ -125,15 +239,7 @@ void Text::RenderObject(const RenderContext& context) const {
     auto& out = context.out;
     out << "<text"sv;
     RenderAttrs(out);
-    out << " x=\""sv << pos_.x << "\" y=\""sv << pos_.y << "\"";
-    out << " dx=\""sv << offset_.x << "\" dy=\""sv << offset_.y << "\"";
-    out << " font-size=\""sv << font_size_ << "\"";
-    if (!font_family_.empty()){
-        out << " font-family=\""sv << font_family_ << "\"";
-    }
-    if (!font_weight_.empty()){
-        out << " font-weight=\""sv << font_weight_ << "\"";
-    }
+    RenderTextPosition(out, pos_, offset_, font_size_, font_family_, font_weight_);
     out << ">"sv;
     out << data_;
     out << "</text>"sv;
@@ -144,13 +250,108 @@ void Document::AddPtr(std::unique_ptr<Object>&& obj){
 }
     
 void Document::Render(std::ostream& out) const{
-    out << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>"sv << std::endl;
-    out << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\">"sv << std::endl;
+    std::string data;
+    Render(data);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+    
+void Document::Render(std::string& out) const{
+    OutputBuffer buffer(out);
+    RenderHeader(buffer);
     for (auto& object : objects_){
-        out << "  "sv;
-        object->Render(out);
+        buffer << "  "sv;
+        object->Render(buffer);
+    }
+    buffer << "</svg>"sv;
+}
+
+FlatDocument::StyleId FlatDocument::AddStyle(const PathAttrs& attrs) {
+    const auto it = std::find(styles_.begin(), styles_.end(), attrs);
+    if (it != styles_.end()) {
+        return static_cast<StyleId>(it - styles_.begin());
+    }
+    styles_.push_back(attrs);
+    return static_cast<StyleId>(styles_.size() - 1);
+}
+
+FlatDocument::FontId FlatDocument::AddFont(const TextFont& font) {
+    const auto it = std::find(fonts_.begin(), fonts_.end(), font);
+    if (it != fonts_.end()) {
+        return static_cast<FontId>(it - fonts_.begin());
+    }
+    fonts_.push_back(font);
+    return static_cast<FontId>(fonts_.size() - 1);
+}
+
+void FlatDocument::AddCircle(Point center, double radius, StyleId style) {
+    commands_.push_back({Kind::CIRCLE, style, 0, 0, 0, center, radius});
+}
+
+void FlatDocument::StartPolyline(StyleId style) {
+    const auto begin = static_cast<uint32_t>(points_.size());
+    commands_.push_back({Kind::POLYLINE, style, 0, begin, begin, {}, 0.});
+}
+
+void FlatDocument::AddPoint(Point point) {
+    points_.push_back(point);
+    ++commands_.back().end;
+}
+
+void FlatDocument::AddText(Point position, std::string_view data, FontId font, StyleId style) {
+    const auto begin = static_cast<uint32_t>(text_.size());
+    AppendEscaped(text_, data);
+    commands_.push_back({Kind::TEXT, style, font, begin, static_cast<uint32_t>(text_.size()), position, 0.});
+}
+
+void FlatDocument::Reserve(size_t command_count, size_t point_count, size_t text_size) {
+    commands_.reserve(command_count);
+    points_.reserve(point_count);
+    text_.reserve(text_size);
+}
+
+void FlatDocument::Render(std::ostream& out) const {
+    std::string data;
+    Render(data);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+void FlatDocument::Render(std::string& out) const {
+    OutputBuffer buffer(out);
+    RenderHeader(buffer);
+    for (const Command& command : commands_) {
+        buffer << "  "sv;
+        switch (command.kind) {
+            case Kind::CIRCLE:
+                RenderCircle(buffer, command.point, command.radius);
+                styles_[command.style].Render(buffer);
+                buffer << "/>"sv;
+                break;
+            case Kind::POLYLINE:
+                buffer << "<polyline points=\""sv;
+                for (uint32_t i = command.begin; i < command.end; ++i) {
+                    if (i != command.begin) {
+                        buffer << ' ';
+                    }
+                    buffer << points_[i].x << ',' << points_[i].y;
+                }
+                buffer << '"';
+                styles_[command.style].Render(buffer);
+                buffer << "/>"sv;
+                break;
+            case Kind::TEXT: {
+                const TextFont& font = fonts_[command.font];
+                buffer << "<text"sv;
+                styles_[command.style].Render(buffer);
+                RenderTextPosition(buffer, command.point, font.offset, font.font_size,
+                                   font.font_family, font.font_weight);
+                buffer << '>' << std::string_view(text_).substr(command.begin, command.end - command.begin)
+                       << "</text>"sv;
+                break;
+            }
+        }
+        buffer << '\n';
     }
-    out << "</svg>"sv;
+    buffer << "</svg>"sv;
 }
 }
 
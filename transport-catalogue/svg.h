@@ -7,8 +7,8 @@
 #include <iostream>
 #include <memory>
 #include<optional>
-#include <regex>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -18,6 +18,8 @@ struct Rgb {
     uint16_t red = 0;
     uint16_t green = 0;
     uint16_t blue = 0;
+
+    bool operator==(const Rgb&) const = default;
 };
 
 struct Rgba {
@@ -25,6 +27,8 @@ struct Rgba {
     uint16_t green = 0;
     uint16_t blue = 0;
     double opacity = 1.0;
+
+    bool operator==(const Rgba&) const = default;
 };
     
 using Color = std::variant<std::monostate, std::string, Rgb, Rgba>;
@@ -45,83 +49,95 @@ enum class StrokeLineJoin {
     ROUND,
 };
 
-struct OstreamColorPrinter {
+std::ostream& operator<<(std::ostream& output, StrokeLineCap cap);
     
-    std::ostream& out;
+std::ostream& operator<<(std::ostream& output, StrokeLineJoin join);
 
-    void operator()(std::monostate) const {
-        out << "none";
+// Собирает SVG в строку без промежуточных потоков. Числа выводятся так же,
+// как их выводит std::ostream по умолчанию (6 значащих цифр).
+class OutputBuffer {
+public:
+    explicit OutputBuffer(std::string& data)
+        : data_(data) {
     }
-    void operator()(const std::string color) const {
-        out << color;
+    
+    OutputBuffer& operator<<(std::string_view text) {
+        data_.append(text);
+        return *this;
     }
-    void operator()(const Rgb color) const {
-        out << "rgb(" << color.red << "," << color.green << "," << color.blue << ")";
+    
+    OutputBuffer& operator<<(const std::string& text) {
+        data_.append(text);
+        return *this;
     }
-    void operator()(const Rgba color) const {
-        out << "rgba(" << color.red << "," << color.green << "," << color.blue << "," << color.opacity << ")";
+    
+    OutputBuffer& operator<<(const char* text) {
+        data_.append(text);
+        return *this;
     }
+    
+    OutputBuffer& operator<<(char c) {
+        data_.push_back(c);
+        return *this;
+    }
+    
+    OutputBuffer& operator<<(int value);
+    OutputBuffer& operator<<(unsigned value);
+    OutputBuffer& operator<<(double value);
+    OutputBuffer& operator<<(const Color& color);
+    OutputBuffer& operator<<(StrokeLineCap cap);
+    OutputBuffer& operator<<(StrokeLineJoin join);
+    
+private:
+    std::string& data_;
 };
     
-std::ostream& operator<<(std::ostream& output, StrokeLineCap cap);
+// Атрибуты заливки и обводки фигуры.
+struct PathAttrs {
+    std::optional<Color> fill_color;
+    std::optional<Color> stroke_color;
+    std::optional<double> stroke_width;
+    std::optional<StrokeLineCap> stroke_line_cap;
+    std::optional<StrokeLineJoin> stroke_line_join;
     
-std::ostream& operator<<(std::ostream& output, StrokeLineJoin join);
-
-inline std::ostream& operator<<(std::ostream& output, const Color& color) {
-    std::ostringstream strm;
-    std::visit(OstreamColorPrinter{strm}, color);
-    output << strm.str();
-    return output;
-}
+    void Render(OutputBuffer& out) const;
+    
+    bool operator==(const PathAttrs&) const = default;
+};
     
 template <typename Owner>
 class PathProps {
 public:
     Owner& SetFillColor(Color color) {
-        fill_color_ = std::move(color);
+        attrs_.fill_color = std::move(color);
         return AsOwner();
     }
     
     Owner& SetStrokeColor(Color color) {
-        stroke_color_ = std::move(color);
+        attrs_.stroke_color = std::move(color);
         return AsOwner();
     }
     
     Owner& SetStrokeWidth(double width) {
-        stroke_width_ = width;
+        attrs_.stroke_width = width;
         return AsOwner();
     }
     
     Owner& SetStrokeLineCap(StrokeLineCap line_cap) {
-        stroke_line_cap_ = line_cap;
+        attrs_.stroke_line_cap = line_cap;
         return AsOwner();
     }
     
     Owner& SetStrokeLineJoin(StrokeLineJoin line_join) {
-        stroke_line_join_ = line_join;
+        attrs_.stroke_line_join = line_join;
         return AsOwner();
     }
 
 protected:
     ~PathProps() = default;
 
-    void RenderAttrs(std::ostream& out) const{
-        using namespace std::literals;
-        if (fill_color_) {
-            out << " fill=\""sv << *fill_color_ << "\""sv;
-        }
-        if (stroke_color_) {
-            out << " stroke=\""sv << *stroke_color_ << "\""sv;
-        }
-        if (stroke_width_) {
-            out << " stroke-width=\""sv << *stroke_width_ << "\""sv;
-        }
-        if (stroke_line_cap_) {
-            out << " stroke-linecap=\""sv << *stroke_line_cap_ << "\""sv;
-        }
-        if (stroke_line_join_) {
-            out << " stroke-linejoin=\""sv << *stroke_line_join_ << "\""sv;
-        }
+    void RenderAttrs(OutputBuffer& out) const{
+        attrs_.Render(out);
     }
 
 private:
@@ -129,11 +145,7 @@ private:
         return static_cast<Owner&>(*this);
     }
 
-    std::optional<Color> fill_color_;
-    std::optional<Color> stroke_color_;
-    std::optional<double> stroke_width_;
-    std::optional<StrokeLineCap> stroke_line_cap_;
-    std::optional<StrokeLineJoin> stroke_line_join_;
+    PathAttrs attrs_;
 };
     
 struct Point {
@@ -144,14 +156,16 @@ struct Point {
     }
     double x = 0;
     double y = 0;
+
+    bool operator==(const Point&) const = default;
 };
 
 struct RenderContext {
-    RenderContext(std::ostream& out)
+    RenderContext(OutputBuffer& out)
         : out(out) {
     }
 
-    RenderContext(std::ostream& out, int indent_step, int indent = 0)
+    RenderContext(OutputBuffer& out, int indent_step, int indent = 0)
         : out(out)
         , indent_step(indent_step)
         , indent(indent) {
@@ -163,11 +177,11 @@ struct RenderContext {
 
     void RenderIndent() const {
         for (int i = 0; i < indent; ++i) {
-            out.put(' ');
+            out << ' ';
         }
     }
 
-    std::ostream& out;
+    OutputBuffer& out;
     int indent_step = 0;
     int indent = 0;
 };
@@ -247,12 +261,77 @@ class Document : public ObjectContainer {
 public:
     void AddPtr(std::unique_ptr<Object>&& obj) override;
 
+    // Документ собирается в буфер и выводится в поток одной записью.
     void Render(std::ostream& out) const;
     
+    // Дописывает документ в конец out.
+    void Render(std::string& out) const;
+    
 private:
     std::vector<std::unique_ptr<Object>> objects_;
 };
     
+// Шрифт и смещение подписи.
+struct TextFont {
+    Point offset;
+    uint32_t font_size = 1;
+    std::string font_family;
+    std::string font_weight;
+    
+    bool operator==(const TextFont&) const = default;
+};
+    
+// Документ в виде плоского буфера команд: элементы лежат подряд в одном
+// массиве без выделения памяти на каждый, наборы атрибутов и шрифты хранятся
+// один раз в таблицах, точки ломаных и тексты подписей - в общих пулах.
+// Выводит то же самое, что Document с такими же элементами.
+class FlatDocument {
+public:
+    using StyleId = uint32_t;
+    using FontId = uint32_t;
+    
+    // Одинаковые стили и шрифты получают один и тот же идентификатор.
+    StyleId AddStyle(const PathAttrs& attrs);
+    FontId AddFont(const TextFont& font);
+    
+    void AddCircle(Point center, double radius, StyleId style);
+    
+    // Начинает ломаную; точки добавляются к последней начатой.
+    void StartPolyline(StyleId style);
+    void AddPoint(Point point);
+    
+    void AddText(Point position, std::string_view data, FontId font, StyleId style);
+    
+    void Reserve(size_t command_count, size_t point_count, size_t text_size);
+    
+    void Render(std::ostream& out) const;
+    void Render(std::string& out) const;
+    
+private:
+    enum class Kind : uint8_t {
+        CIRCLE,
+        POLYLINE,
+        TEXT,
+    };
+    
+    // Для ломаной [begin, end) - диапазон в points_, для подписи - в text_.
+    struct Command {
+        Kind kind;
+        StyleId style;
+        FontId font;
+        uint32_t begin;
+        uint32_t end;
+        Point point;
+        double radius;
+    };
+    
+    std::vector<Command> commands_;
+    std::vector<PathAttrs> styles_;
+    std::vector<TextFont> fonts_;
+    std::vector<Point> points_;
+    std::string text_;
+};
+    
 }
 
 namespace shapes {
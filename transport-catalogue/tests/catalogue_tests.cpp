@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "json_reader.h"
+#include "spatial_index.h"
+#include "tests.h"
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+// Автобус 1 проходит перегон B - C без заданного расстояния, автобус 2 целиком задан.
+const std::string_view BASE_WITH_MISSING_DISTANCE = R"({
+    "base_requests": [
+        {"type": "Stop", "name": "A", "latitude": 55.60, "longitude": 37.60, "road_distances": {"B": 1000}},
+        {"type": "Stop", "name": "B", "latitude": 55.61, "longitude": 37.61, "road_distances": {}},
+        {"type": "Stop", "name": "C", "latitude": 55.62, "longitude": 37.62, "road_distances": {}},
+        {"type": "Bus", "name": "1", "stops": ["A", "B", "C"], "is_roundtrip": false},
+        {"type": "Bus", "name": "2", "stops": ["A", "B"], "is_roundtrip": false}
+    ],
+    "render_settings": {
+        "width": 600, "height": 400, "padding": 50, "line_width": 14, "stop_radius": 5,
+        "bus_label_font_size": 20, "bus_label_offset": [7, 15], "stop_label_font_size": 20,
+        "stop_label_offset": [7, -3], "underlayer_color": "white", "underlayer_width": 3,
+        "color_palette": ["green", "red"]
+    },
+    "routing_settings": {"bus_wait_time": 6, "bus_velocity": 40},
+    "stat_requests": [
+        {"id": 1, "type": "Bus", "name": "1"},
+        {"id": 2, "type": "Bus", "name": "2"},
+        {"id": 3, "type": "Stop", "name": "C"},
+        {"id": 4, "type": "Route", "from": "A", "to": "C"},
+        {"id": 5, "type": "Route", "from": "A", "to": "B"},
+        {"id": 6, "type": "Map"}
+    ]
+})"sv;
+
+// Маршрут без расстояния на одном перегоне не мешает загрузке и остальным запросам.
+void TestMissingRoadDistance() {
+    transport_catalogue::TransportCatalogue catalogue;
+    json_reader::JSONReader reader(catalogue);
+    std::ostringstream output;
+    reader.Requests(BASE_WITH_MISSING_DISTANCE, output);
+    ASSERT(catalogue.IsFrozen());
+    ASSERT(!catalogue.GetBusStat("1"sv)->has_road_distances);
+    ASSERT(catalogue.GetBusStat("2"sv)->has_road_distances);
+    ASSERT_EQUAL(catalogue.GetBusStat("2"sv)->route_length, 2000);
+
+    const json::Array answers = json::Load(output.str()).GetRoot().AsArray();
+    ASSERT_EQUAL(answers.size(), 6u);
+    ASSERT_EQUAL(answers[0].AsMap().at("error_message"s).AsString(), "road distances are missing"s);
+    ASSERT_EQUAL(answers[0].AsMap().at("request_id"s).AsInt(), 1);
+    ASSERT_EQUAL(answers[1].AsMap().at("route_length"s).AsInt(), 2000);
+    ASSERT_EQUAL(answers[2].AsMap().at("buses"s).AsArray().size(), 1u);
+    // По автобусу 1 проехать нельзя, поэтому до C не добраться.
+    ASSERT_EQUAL(answers[3].AsMap().at("error_message"s).AsString(), "not found"s);
+    ASSERT(answers[4].AsMap().count("total_time"s) != 0);
+    ASSERT(answers[5].AsMap().count("map"s) != 0);
+}
+
+// Точки на небольшом участке с повторами, чтобы были совпадения координат и
+// точки ровно на границах прямоугольников.
+std::vector<geo::Coordinates> MakeSpatialPoints(uint32_t seed, size_t count) {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> grid(0, 40);
+    std::vector<geo::Coordinates> points;
+    for (size_t i = 0; i < count; ++i) {
+        points.push_back({55.5 + grid(random) * 0.01, 37.5 + grid(random) * 0.01});
+    }
+    return points;
+}
+
+std::vector<uint32_t> FindInBoxBruteForce(const std::vector<geo::Coordinates>& points, geo::Coordinates min,
+                                          geo::Coordinates max) {
+    std::vector<uint32_t> result;
+    for (uint32_t id = 0; id < points.size(); ++id) {
+        if (min.lat <= points[id].lat && points[id].lat <= max.lat && min.lng <= points[id].lng
+            && points[id].lng <= max.lng) {
+            result.push_back(id);
+        }
+    }
+    return result;
+}
+
+// Ближайшие перебором: по длине хорды на единичной сфере, при равенстве - по индексу.
+std::vector<std::pair<uint32_t, double>> FindNearestBruteForce(const std::vector<geo::Coordinates>& points,
+                                                               geo::Coordinates point, size_t count) {
+    const auto to_sphere = [](geo::Coordinates coord) {
+        const double lat = coord.lat * geo::DEGREES_TO_RADIANS;
+        const double lng = coord.lng * geo::DEGREES_TO_RADIANS;
+        return std::array<double, 3>{std::cos(lat) * std::cos(lng), std::cos(lat) * std::sin(lng), std::sin(lat)};
+    };
+    const auto query = to_sphere(point);
+    std::vector<std::pair<double, uint32_t>> chords;
+    for (uint32_t id = 0; id < points.size(); ++id) {
+        const auto xyz = to_sphere(points[id]);
+        double chord2 = 0.;
+        for (int i = 0; i < 3; ++i) {
+            chord2 += (xyz[i] - query[i]) * (xyz[i] - query[i]);
+        }
+        chords.emplace_back(chord2, id);
+    }
+    std::sort(chords.begin(), chords.end());
+    chords.resize(std::min(count, chords.size()));
+    std::vector<std::pair<uint32_t, double>> result;
+    for (const auto& [chord2, id] : chords) {
+        result.emplace_back(id, 2. * std::asin(std::min(std::sqrt(chord2) / 2., 1.)) * geo::EARTH_RADIUS);
+    }
+    return result;
+}
+
+void TestSpatialIndexMatchesBruteForce() {
+    const std::vector<geo::Coordinates> points = MakeSpatialPoints(7, 500);
+    transport_catalogue::SpatialIndex index;
+    index.Build(points);
+
+    std::mt19937 random(8);
+    std::uniform_int_distribution<int> grid(-2, 42);
+    for (int i = 0; i < 300; ++i) {
+        geo::Coordinates min{55.5 + grid(random) * 0.01, 37.5 + grid(random) * 0.01};
+        geo::Coordinates max{55.5 + grid(random) * 0.01, 37.5 + grid(random) * 0.01};
+        if (i % 2 == 0) {
+            std::tie(min.lat, max.lat) = std::minmax(min.lat, max.lat);
+            std::tie(min.lng, max.lng) = std::minmax(min.lng, max.lng);
+        }
+        std::vector<uint32_t> found = index.FindInBox(min, max);
+        std::sort(found.begin(), found.end());
+        ASSERT(found == FindInBoxBruteForce(points, min, max));
+    }
+
+    for (int i = 0; i < 300; ++i) {
+        const geo::Coordinates point{55.5 + grid(random) * 0.01, 37.5 + grid(random) * 0.01};
+        const size_t count = static_cast<size_t>(i % 12);
+        ASSERT(index.FindNearest(point, count) == FindNearestBruteForce(points, point, count));
+    }
+}
+
+void TestSpatialIndexBoundaries() {
+    const std::vector<geo::Coordinates> points = {{55.6, 37.6}, {55.7, 37.7}, {55.7, 37.7}, {55.8, 37.5}};
+    transport_catalogue::SpatialIndex index;
+    index.Build(points);
+
+    // Границы прямоугольника включаются, в том числе вырожденного в точку.
+    std::vector<uint32_t> found = index.FindInBox({55.6, 37.6}, {55.7, 37.7});
+    std::sort(found.begin(), found.end());
+    ASSERT((found == std::vector<uint32_t>{0, 1, 2}));
+    found = index.FindInBox({55.7, 37.7}, {55.7, 37.7});
+    std::sort(found.begin(), found.end());
+    ASSERT((found == std::vector<uint32_t>{1, 2}));
+    ASSERT(index.FindInBox({55.8, 37.5}, {55.8, 37.5}) == std::vector<uint32_t>{3});
+    ASSERT(index.FindInBox({55.61, 37.61}, {55.69, 37.69}).empty());
+    ASSERT(index.FindInBox({55.8, 37.8}, {55.6, 37.6}).empty());
+
+    // count больше числа точек - возвращаются все, совпадающие точки по индексу.
+    const auto nearest = index.FindNearest({55.7, 37.7}, 100);
+    ASSERT_EQUAL(nearest.size(), points.size());
+    ASSERT(nearest == FindNearestBruteForce(points, {55.7, 37.7}, 100));
+    ASSERT_EQUAL(nearest[0].first, 1u);
+    ASSERT_EQUAL(nearest[1].first, 2u);
+    ASSERT_EQUAL(nearest[0].second, 0.);
+    ASSERT(index.FindNearest({55.7, 37.7}, 0).empty());
+
+    transport_catalogue::SpatialIndex empty;
+    empty.Build({});
+    ASSERT(empty.FindInBox({-90., -180.}, {90., 180.}).empty());
+    ASSERT(empty.FindNearest({55.7, 37.7}, 5).empty());
+
+    transport_catalogue::TransportCatalogue catalogue;
+    catalogue.Freeze();
+    ASSERT(catalogue.GetStopsInBox({-90., -180.}, {90., 180.}).empty());
+    ASSERT(catalogue.GetNearestStops({55.7, 37.7}, 5).empty());
+}
+
+}  // namespace
+
+void RunCatalogueTests(TestRunner& runner) {
+    RUN_TEST(runner, TestMissingRoadDistance);
+    RUN_TEST(runner, TestSpatialIndexMatchesBruteForce);
+    RUN_TEST(runner, TestSpatialIndexBoundaries);
+}
+
+}  // namespace tests
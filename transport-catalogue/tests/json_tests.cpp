@@ -0,0 +1,123 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json.h"
+#include "tests.h"
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+std::string PrintToString(const json::Node& node) {
+    std::ostringstream out;
+    json::Print(json::Document{node}, out);
+    return out.str();
+}
+
+// Сравнивает double побитово, чтобы отличать и потерю младших разрядов.
+bool IsSameBits(double lhs, double rhs) {
+    return std::memcmp(&lhs, &rhs, sizeof(double)) == 0;
+}
+
+void TestShortestDoubleOutput() {
+    ASSERT_EQUAL(PrintToString(0.1), "0.1"s);
+    ASSERT_EQUAL(PrintToString(55.611087), "55.611087"s);
+    ASSERT_EQUAL(PrintToString(37.20829), "37.20829"s);
+    ASSERT_EQUAL(PrintToString(-1.5), "-1.5"s);
+    ASSERT_EQUAL(PrintToString(1e+300), "1e+300"s);
+}
+
+void TestDoubleRoundTrip() {
+    std::vector<double> values = {
+        0.1, 55.611087, 37.20829, 1. / 3., 2.5e-8, 123456.789, 1e+300, -1e-300,
+        std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::max(),
+        std::numeric_limits<double>::lowest(), std::numeric_limits<double>::epsilon(),
+    };
+    // Случайные координаты и случайные конечные битовые образы.
+    std::mt19937_64 generator(5);
+    std::uniform_real_distribution<double> latitude(-90., 90.);
+    for (int i = 0; i < 10000; ++i) {
+        values.push_back(latitude(generator));
+        double value;
+        do {
+            const uint64_t bits = generator();
+            std::memcpy(&value, &bits, sizeof(value));
+        } while (!std::isfinite(value));
+        values.push_back(value);
+    }
+
+    for (const double value : values) {
+        const std::string text = PrintToString(value);
+        const double loaded = json::Load(text).GetRoot().AsDouble();
+        if (!IsSameBits(loaded, value) && !(value == 0. && loaded == 0.)) {
+            throw std::runtime_error("Double "s + text + " does not round-trip"s);
+        }
+    }
+}
+
+void TestIntRoundTrip() {
+    for (const int value : {0, -1, 1, 42, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()}) {
+        const json::Node loaded = json::Load(PrintToString(value)).GetRoot();
+        ASSERT(loaded.IsInt());
+        ASSERT_EQUAL(loaded.AsInt(), value);
+    }
+    // Целое вне диапазона int читается как double без исключений.
+    const json::Node big = json::Load("2147483648"sv).GetRoot();
+    ASSERT(big.IsPureDouble());
+    ASSERT_EQUAL(big.AsDouble(), 2147483648.);
+    const json::Node exponent = json::Load("1e2"sv).GetRoot();
+    ASSERT(exponent.IsPureDouble());
+    ASSERT_EQUAL(exponent.AsDouble(), 100.);
+}
+
+void TestInvalidNumbers() {
+    for (const std::string_view text : {"-"sv, "1."sv, "1e"sv, "1e+"sv, ".5"sv, "+1"sv, "-x"sv}) {
+        bool is_thrown = false;
+        try {
+            json::Load(text);
+        } catch (const json::ParsingError&) {
+            is_thrown = true;
+        }
+        if (!is_thrown) {
+            throw std::runtime_error("Invalid number "s + std::string(text) + " was accepted"s);
+        }
+    }
+}
+
+// Числа на границе блоков чтения из потока разбираются так же, как из буфера.
+void TestNumbersAcrossStreamBlocks() {
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<double> coordinate(-180., 180.);
+    std::string text = "["s;
+    for (int i = 0; i < 20000; ++i) {
+        text += i != 0 ? ","s : ""s;
+        text += PrintToString(i % 3 == 0 ? json::Node(static_cast<int>(generator() % 100000)) : json::Node(coordinate(generator)));
+    }
+    text += "]"s;
+
+    std::istringstream input(text);
+    const json::Document from_stream = json::Load(input);
+    const json::Document from_buffer = json::Load(std::string_view(text));
+    ASSERT(from_stream.GetRoot() == from_buffer.GetRoot());
+    ASSERT_EQUAL(from_stream.GetRoot().AsArray().size(), 20000u);
+}
+
+}  // namespace
+
+void RunJsonTests(TestRunner& runner) {
+    RUN_TEST(runner, TestShortestDoubleOutput);
+    RUN_TEST(runner, TestDoubleRoundTrip);
+    RUN_TEST(runner, TestIntRoundTrip);
+    RUN_TEST(runner, TestInvalidNumbers);
+    RUN_TEST(runner, TestNumbersAcrossStreamBlocks);
+}
+
+}  // namespace tests
@@ -0,0 +1,17 @@
+#include <iostream>
+
+#include "tests.h"
+
+int main() {
+    tests::TestRunner runner;
+    tests::RunJsonTests(runner);
+    tests::RunCatalogueTests(runner);
+    tests::RunSerializationTests(runner);
+    tests::RunRouterTests(runner);
+    tests::RunRenderTests(runner);
+    tests::RunServerTests(runner);
+    if (runner.GetFailedCount() != 0) {
+        std::cerr << runner.GetFailedCount() << " test(s) failed\n";
+        return 1;
+    }
+}
@@ -0,0 +1,206 @@
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "map_renderer.h"
+#include "svg.h"
+#include "tests.h"
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+template <typename Owner>
+void SetAttrs(svg::PathProps<Owner>& object, const svg::PathAttrs& attrs) {
+    if (attrs.fill_color) {
+        object.SetFillColor(*attrs.fill_color);
+    }
+    if (attrs.stroke_color) {
+        object.SetStrokeColor(*attrs.stroke_color);
+    }
+    if (attrs.stroke_width) {
+        object.SetStrokeWidth(*attrs.stroke_width);
+    }
+    if (attrs.stroke_line_cap) {
+        object.SetStrokeLineCap(*attrs.stroke_line_cap);
+    }
+    if (attrs.stroke_line_join) {
+        object.SetStrokeLineJoin(*attrs.stroke_line_join);
+    }
+}
+
+// Числа разного порядка, чтобы встретились и экспоненциальная запись, и округление.
+double MakeNumber(std::mt19937& random) {
+    static const double SCALES[] = {1e-7, 0.001, 1., 37.5, 600., 123456., 1e9};
+    std::uniform_int_distribution<int> scale(0, std::size(SCALES) - 1);
+    std::uniform_real_distribution<double> value(-1., 1.);
+    return value(random) * SCALES[scale(random)];
+}
+
+svg::PathAttrs MakeAttrs(std::mt19937& random) {
+    static const svg::Color COLORS[] = {
+        svg::NoneColor, "green"s, svg::Rgb{255, 16, 12}, svg::Rgba{1, 2, 3, 0.85}, svg::Rgba{255, 255, 255, 0.1 + 0.2},
+    };
+    std::uniform_int_distribution<int> pick(0, 5);
+    svg::PathAttrs attrs;
+    if (const int i = pick(random); i < 5) {
+        attrs.fill_color = COLORS[i];
+    }
+    if (const int i = pick(random); i < 5) {
+        attrs.stroke_color = COLORS[i];
+    }
+    if (pick(random) < 3) {
+        attrs.stroke_width = MakeNumber(random);
+    }
+    if (const int i = pick(random); i < 3) {
+        attrs.stroke_line_cap = static_cast<svg::StrokeLineCap>(i);
+    }
+    if (const int i = pick(random); i < 5) {
+        attrs.stroke_line_join = static_cast<svg::StrokeLineJoin>(i);
+    }
+    return attrs;
+}
+
+// FlatDocument с теми же элементами выводит побайтно то же, что Document.
+void TestFlatDocumentMatchesDocument() {
+    static const std::string_view TEXTS[] = {""sv, "Bus 14"sv, "<Ulitsa & \"Lesnaya\">"sv, "it's"sv, "Улица"sv};
+    std::mt19937 random(19);
+    std::uniform_int_distribution<int> pick(0, 4);
+    svg::Document document;
+    svg::FlatDocument flat;
+    for (int i = 0; i < 400; ++i) {
+        const svg::PathAttrs attrs = MakeAttrs(random);
+        const svg::Point point(MakeNumber(random), MakeNumber(random));
+        const int kind = i % 3;
+        if (kind == 0) {
+            const double radius = MakeNumber(random);
+            svg::Circle circle;
+            circle.SetCenter(point).SetRadius(radius);
+            SetAttrs(circle, attrs);
+            document.Add(std::move(circle));
+            flat.AddCircle(point, radius, flat.AddStyle(attrs));
+        } else if (kind == 1) {
+            svg::Polyline polyline;
+            SetAttrs(polyline, attrs);
+            flat.StartPolyline(flat.AddStyle(attrs));
+            for (int j = pick(random); j > 0; --j) {
+                const svg::Point next(MakeNumber(random), MakeNumber(random));
+                polyline.AddPoint(next);
+                flat.AddPoint(next);
+            }
+            document.Add(std::move(polyline));
+        } else {
+            svg::TextFont font;
+            font.offset = {MakeNumber(random), MakeNumber(random)};
+            font.font_size = static_cast<uint32_t>(pick(random) * 7 + 1);
+            font.font_family = pick(random) < 2 ? "Verdana"s : ""s;
+            font.font_weight = pick(random) < 2 ? "bold"s : ""s;
+            const std::string_view data = TEXTS[pick(random)];
+            svg::Text text;
+            text.SetPosition(point).SetOffset(font.offset).SetFontSize(font.font_size).SetData(std::string(data));
+            if (!font.font_family.empty()) {
+                text.SetFontFamily(font.font_family);
+            }
+            if (!font.font_weight.empty()) {
+                text.SetFontWeight(font.font_weight);
+            }
+            SetAttrs(text, attrs);
+            document.Add(std::move(text));
+            flat.AddText(point, data, flat.AddFont(font), flat.AddStyle(attrs));
+        }
+    }
+
+    std::string expected;
+    document.Render(expected);
+    std::string actual;
+    flat.Render(actual);
+    ASSERT(actual == expected);
+    std::ostringstream stream;
+    flat.Render(stream);
+    ASSERT(stream.str() == expected);
+
+    std::string empty;
+    svg::FlatDocument().Render(empty);
+    std::string empty_expected;
+    svg::Document().Render(empty_expected);
+    ASSERT(empty == empty_expected);
+}
+
+// OutputBuffer выводит числа так же, как std::ostream по умолчанию.
+void TestOutputBufferNumbers() {
+    std::vector<double> values = {0., -0., 1., 0.5, 1e-7, 123456., 1234567., 1e21, 0.1 + 0.2, 600. / 7.,
+                                  std::numeric_limits<double>::infinity(), std::numeric_limits<double>::max()};
+    std::mt19937 random(20);
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(MakeNumber(random));
+    }
+    for (const double value : values) {
+        std::string data;
+        svg::OutputBuffer(data) << value;
+        std::ostringstream expected;
+        expected << value;
+        ASSERT_EQUAL(data, expected.str());
+    }
+    for (const int value : {0, -1, 42, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()}) {
+        std::string data;
+        svg::OutputBuffer(data) << value;
+        ASSERT_EQUAL(data, std::to_string(value));
+    }
+}
+
+const std::string_view RENDER_SETTINGS = R"({
+    "width": 600, "height": 400, "padding": 50, "line_width": 14, "stop_radius": 5,
+    "bus_label_font_size": 20, "bus_label_offset": [7, 15], "stop_label_font_size": 20,
+    "stop_label_offset": [7, -3], "underlayer_color": "white", "underlayer_width": 3,
+    "color_palette": ["green", "red"]
+})"sv;
+
+// Карта берётся из кеша, пока не изменились справочник и настройки, и
+// перерисовывается после изменения справочника (GetVersion) или настроек.
+void TestMapCacheInvalidation() {
+    const map_renderer::Mapping mapping = map_renderer::RenderSettings(json::Load(RENDER_SETTINGS).GetRoot().AsMap());
+    transport_catalogue::TransportCatalogue catalogue;
+    catalogue.AddStop("A"sv, {55.60, 37.60});
+    catalogue.AddStop("B"sv, {55.61, 37.61});
+    catalogue.AddDistanceStops("A"sv, "B"sv, 1000);
+    catalogue.AddBus("1"sv, std::vector<std::string_view>{"A"sv, "B"sv}, false);
+    catalogue.Freeze();
+
+    map_renderer::MapCache cache;
+    const auto first = cache.GetMap(catalogue, mapping);
+    ASSERT(*first == map_renderer::DrawRoute(catalogue, mapping));
+    ASSERT(cache.GetMap(catalogue, mapping) == first);
+
+    const uint64_t version = catalogue.GetVersion();
+    catalogue.AddStop("C"sv, {55.62, 37.62});
+    catalogue.AddDistanceStops("B"sv, "C"sv, 1000);
+    catalogue.AddBus("2"sv, std::vector<std::string_view>{"B"sv, "C"sv}, true);
+    catalogue.Freeze();
+    ASSERT(catalogue.GetVersion() != version);
+    const auto second = cache.GetMap(catalogue, mapping);
+    ASSERT(second != first);
+    ASSERT(*second != *first);
+    ASSERT(*second == map_renderer::DrawRoute(catalogue, mapping));
+    ASSERT(cache.GetMap(catalogue, mapping) == second);
+
+    map_renderer::Mapping wider = mapping;
+    wider.width *= 2.;
+    const auto third = cache.GetMap(catalogue, wider);
+    ASSERT(third != second);
+    ASSERT(*third == map_renderer::DrawRoute(catalogue, wider));
+}
+
+}  // namespace
+
+void RunRenderTests(TestRunner& runner) {
+    RUN_TEST(runner, TestFlatDocumentMatchesDocument);
+    RUN_TEST(runner, TestOutputBufferNumbers);
+    RUN_TEST(runner, TestMapCacheInvalidation);
+}
+
+}  // namespace tests
@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <map>
+#include <optional>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "json_reader.h"
+#include "test_data.h"
+#include "tests.h"
+#include "transport_router.h"
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+constexpr double INF = std::numeric_limits<double>::infinity();
+constexpr int WAIT_TIME = 6;
+constexpr double VELOCITY = 40.;
+constexpr double METERS_PER_MINUTE = VELOCITY * 1000. / 60.;
+
+bool IsClose(double lhs, double rhs) {
+    return std::abs(lhs - rhs) <= 1e-9 * std::max(1., std::abs(rhs));
+}
+
+// Модель маршрутов, построенная прямо по base_requests, без справочника.
+// Поездка - отрезок одной цепочки автобуса: кольцевой маршрут - одна
+// цепочка, некольцевой - две, туда и обратно, с пересадкой на конечной.
+class ReferenceModel {
+public:
+    explicit ReferenceModel(const TestBase& base)
+        : base_(base)
+        , index_by_name_() {
+        for (size_t i = 0; i < base.stop_names.size(); ++i) {
+            index_by_name_[base.stop_names[i]] = static_cast<int>(i);
+        }
+        for (const auto& bus : base.buses) {
+            std::vector<int> route = bus.stops;
+            if (!bus.is_roundtrip) {
+                route.insert(route.end(), std::next(bus.stops.rbegin()), bus.stops.rend());
+            }
+            const size_t turn = bus.is_roundtrip ? route.size() - 1 : bus.stops.size() - 1;
+            for (const auto& [begin, end] : {std::pair{size_t{0}, turn}, std::pair{turn, route.size() - 1}}) {
+                if (begin == end) {
+                    continue;
+                }
+                Chain chain{bus.name, {}, {0}};
+                for (size_t i = begin; i <= end; ++i) {
+                    chain.stops.push_back(route[i]);
+                    if (i != begin) {
+                        chain.distances.push_back(chain.distances.back() + GetDistance(route[i - 1], route[i]));
+                    }
+                }
+                chains_.push_back(std::move(chain));
+            }
+        }
+    }
+
+    int GetStopIndex(const std::string& name) const {
+        return index_by_name_.at(name);
+    }
+
+    // Дейкстра по полному графу поездок: ребро из каждой остановки цепочки
+    // в каждую следующую весом ожидание + время в пути.
+    std::vector<double> FindTimes(int from) const {
+        return Dijkstra<double>(from, [this](int stop, const auto& relax) {
+            for (const auto& chain : chains_) {
+                for (size_t i = 0; i < chain.stops.size(); ++i) {
+                    if (chain.stops[i] != stop) {
+                        continue;
+                    }
+                    for (size_t j = i + 1; j < chain.stops.size(); ++j) {
+                        relax(chain.stops[j], WAIT_TIME + (chain.distances[j] - chain.distances[i]) / METERS_PER_MINUTE);
+                    }
+                }
+            }
+        });
+    }
+
+    // Дейкстра по перегонам между соседними остановками маршрутов.
+    std::vector<double> FindDistances(int from) const {
+        return Dijkstra<double>(from, [this](int stop, const auto& relax) {
+            for (const auto& chain : chains_) {
+                for (size_t i = 0; i + 1 < chain.stops.size(); ++i) {
+                    if (chain.stops[i] == stop) {
+                        relax(chain.stops[i + 1], chain.distances[i + 1] - chain.distances[i]);
+                    }
+                }
+            }
+        });
+    }
+
+    // Остановки, где можно выйти, проехав span_count перегонов автобусом bus
+    // от остановки from за time минут.
+    std::set<int> FindRideEnds(const std::string& bus, int from, int span_count, double time) const {
+        std::set<int> ends;
+        for (const auto& chain : chains_) {
+            if (chain.bus != bus) {
+                continue;
+            }
+            for (size_t i = 0; i + span_count < chain.stops.size(); ++i) {
+                const double ride = (chain.distances[i + span_count] - chain.distances[i]) / METERS_PER_MINUTE;
+                if (chain.stops[i] == from && IsClose(time, ride)) {
+                    ends.insert(chain.stops[i + span_count]);
+                }
+            }
+        }
+        return ends;
+    }
+
+private:
+    struct Chain {
+        std::string bus;
+        std::vector<int> stops;
+        // Расстояние от начала цепочки до каждой остановки.
+        std::vector<double> distances;
+    };
+
+    // Расстояние, заданное в base_requests, с подстановкой обратного направления.
+    int GetDistance(int from, int to) const {
+        const json::Dict& forward = base_.base_requests[from].AsMap().at("road_distances"s).AsMap();
+        if (const auto it = forward.find(base_.stop_names[to]); it != forward.end()) {
+            return it->second.AsInt();
+        }
+        return base_.base_requests[to].AsMap().at("road_distances"s).AsMap().at(base_.stop_names[from]).AsInt();
+    }
+
+    template <typename Weight, typename ForEachEdge>
+    std::vector<Weight> Dijkstra(int from, ForEachEdge for_each_edge) const {
+        std::vector<Weight> dist(base_.stop_names.size(), INF);
+        std::priority_queue<std::pair<Weight, int>, std::vector<std::pair<Weight, int>>, std::greater<>> queue;
+        dist[from] = 0;
+        queue.emplace(0, from);
+        while (!queue.empty()) {
+            const auto [distance, stop] = queue.top();
+            queue.pop();
+            if (distance > dist[stop]) {
+                continue;
+            }
+            for_each_edge(stop, [&](int to, Weight weight) {
+                if (distance + weight < dist[to]) {
+                    dist[to] = distance + weight;
+                    queue.emplace(dist[to], to);
+                }
+            });
+        }
+        return dist;
+    }
+
+    const TestBase& base_;
+    std::map<std::string, int> index_by_name_;
+    std::vector<Chain> chains_;
+};
+
+std::string RunRequests(const std::string& document, size_t thread_count) {
+    transport_catalogue::TransportCatalogue catalogue;
+    json_reader::JSONReader reader(catalogue);
+    reader.SetThreadCount(thread_count);
+    std::ostringstream output;
+    reader.Requests(std::string_view(document), output);
+    return output.str();
+}
+
+json::Array MakeStatRequests(const TestBase& base) {
+    json::Array requests;
+    const int stop_count = static_cast<int>(base.stop_names.size());
+    int id = 0;
+    for (int from = 0; from < stop_count; from += 2) {
+        for (int to = 0; to < stop_count; to += 3) {
+            requests.push_back(json::Dict{{"id"s, id++}, {"type"s, "Route"s},
+                                          {"from"s, base.stop_names[from]}, {"to"s, base.stop_names[to]}});
+        }
+    }
+    for (int from = 0; from < stop_count; from += 7) {
+        requests.push_back(json::Dict{{"id"s, id++}, {"type"s, "Reachable"s},
+                                      {"from"s, base.stop_names[from]}, {"max_time"s, 23.7}});
+        requests.push_back(json::Dict{{"id"s, id++}, {"type"s, "Reachable"s},
+                                      {"from"s, base.stop_names[from]}, {"max_distance"s, 4000}});
+    }
+    json::Array matrix_stops;
+    for (int i = 0; i < stop_count; i += 4) {
+        matrix_stops.push_back(base.stop_names[i]);
+    }
+    requests.push_back(json::Dict{{"id"s, id++}, {"type"s, "DistanceMatrix"s}, {"stops"s, matrix_stops}});
+    requests.push_back(json::Dict{{"id"s, id++}, {"type"s, "Route"s},
+                                  {"from"s, base.stop_names[0]}, {"to"s, "Unknown"s}});
+    return requests;
+}
+
+void CheckRoute(const ReferenceModel& model, const json::Dict& request, const json::Dict& answer) {
+    const int from = model.GetStopIndex(request.at("from"s).AsString());
+    const int to = model.GetStopIndex(request.at("to"s).AsString());
+    const double expected = model.FindTimes(from)[to];
+    if (expected == INF) {
+        ASSERT_EQUAL(answer.at("error_message"s).AsString(), "not found"s);
+        return;
+    }
+    const double total_time = answer.at("total_time"s).AsDouble();
+    ASSERT(IsClose(total_time, expected));
+
+    // Маршрут должен быть настоящим: ожидание на той остановке, где
+    // находишься, поездки по существующим отрезкам маршрутов, выход в to.
+    std::set<int> positions = {from};
+    double sum = 0.;
+    int wait_stop = -1;
+    for (const auto& item_node : answer.at("items"s).AsArray()) {
+        const json::Dict& item = item_node.AsMap();
+        sum += item.at("time"s).AsDouble();
+        if (item.at("type"s).AsString() == "Wait"s) {
+            wait_stop = model.GetStopIndex(item.at("stop_name"s).AsString());
+            ASSERT(positions.count(wait_stop) == 1);
+            ASSERT_EQUAL(item.at("time"s).AsDouble(), static_cast<double>(WAIT_TIME));
+        } else {
+            ASSERT(wait_stop >= 0);
+            positions = model.FindRideEnds(item.at("bus"s).AsString(), wait_stop,
+                                           item.at("span_count"s).AsInt(), item.at("time"s).AsDouble());
+            wait_stop = -1;
+        }
+    }
+    ASSERT(wait_stop < 0);
+    ASSERT(positions.count(to) == 1);
+    ASSERT(IsClose(sum, total_time));
+}
+
+template <typename Value>
+void CheckReached(const std::vector<double>& expected, Value limit, const TestBase& base, const json::Array& stops,
+                  const std::string& value_key) {
+    std::map<std::string, double> reached;
+    for (const auto& stop : stops) {
+        reached[stop.AsMap().at("name"s).AsString()] = stop.AsMap().at(value_key).AsDouble();
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        // Значения на самой границе не проверяются: они зависят от округления.
+        if (IsClose(expected[i], limit)) {
+            continue;
+        }
+        const auto it = reached.find(base.stop_names[i]);
+        ASSERT_EQUAL(it != reached.end(), expected[i] <= limit);
+        if (it != reached.end()) {
+            ASSERT(IsClose(it->second, expected[i]));
+        }
+    }
+    // Ближние первыми, при равенстве - по названию.
+    for (size_t i = 1; i < stops.size(); ++i) {
+        const json::Dict& lhs = stops[i - 1].AsMap();
+        const json::Dict& rhs = stops[i].AsMap();
+        ASSERT(lhs.at(value_key).AsDouble() < rhs.at(value_key).AsDouble()
+               || (lhs.at(value_key).AsDouble() == rhs.at(value_key).AsDouble()
+                   && lhs.at("name"s).AsString() < rhs.at("name"s).AsString()));
+    }
+}
+
+void CheckAnswers(const TestBase& base, const json::Array& requests, const json::Array& answers) {
+    const ReferenceModel model(base);
+    ASSERT_EQUAL(answers.size(), requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const json::Dict& request = requests[i].AsMap();
+        const json::Dict& answer = answers[i].AsMap();
+        ASSERT(answer.at("request_id"s) == request.at("id"s));
+        const std::string& type = request.at("type"s).AsString();
+        if (type == "Route"s && request.at("to"s).AsString() == "Unknown"s) {
+            ASSERT_EQUAL(answer.at("error_message"s).AsString(), "not found"s);
+        } else if (type == "Route"s) {
+            CheckRoute(model, request, answer);
+        } else if (type == "Reachable"s) {
+            const int from = model.GetStopIndex(request.at("from"s).AsString());
+            if (request.count("max_time"s) != 0) {
+                CheckReached(model.FindTimes(from), request.at("max_time"s).AsDouble(), base,
+                             answer.at("stops"s).AsArray(), "time"s);
+            } else {
+                CheckReached(model.FindDistances(from), request.at("max_distance"s).AsInt(), base,
+                             answer.at("stops"s).AsArray(), "distance"s);
+            }
+        } else if (type == "DistanceMatrix"s) {
+            const json::Array& stops = request.at("stops"s).AsArray();
+            const json::Array& times = answer.at("times"s).AsArray();
+            ASSERT_EQUAL(times.size(), stops.size());
+            for (size_t row = 0; row < stops.size(); ++row) {
+                const std::vector<double> expected = model.FindTimes(model.GetStopIndex(stops[row].AsString()));
+                const json::Array& cells = times[row].AsArray();
+                ASSERT_EQUAL(cells.size(), stops.size());
+                for (size_t column = 0; column < stops.size(); ++column) {
+                    const double time = expected[model.GetStopIndex(stops[column].AsString())];
+                    ASSERT_EQUAL(cells[column].IsNull(), time == INF);
+                    if (time != INF) {
+                        ASSERT(IsClose(cells[column].AsDouble(), time));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Route, Reachable и DistanceMatrix совпадают с обычным Дейкстрой на
+// нескольких случайных справочниках, при любом числе потоков.
+void TestRoutingMatchesDijkstra() {
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+        const TestBase base = MakeTestBase(seed, 80, 20);
+        const json::Array requests = MakeStatRequests(base);
+        const std::string document = MakeRequestsDocument(base, WAIT_TIME, VELOCITY, requests);
+        const std::string output = RunRequests(document, 1);
+        CheckAnswers(base, requests, json::Load(output).GetRoot().AsArray());
+        ASSERT(RunRequests(document, 4) == output);
+    }
+}
+
+// На густой сети сжатие останавливается на ядре, и запросы через него
+// по-прежнему совпадают с Дейкстрой.
+void TestDenseNetworkCore() {
+    const TestBase base = MakeTestBase(11, 40, 40);
+    const json::Array requests = MakeStatRequests(base);
+    const std::string document = MakeRequestsDocument(base, WAIT_TIME, VELOCITY, requests);
+
+    transport_catalogue::TransportCatalogue catalogue;
+    json_reader::JSONReader(catalogue).LoadRequests(document);
+    const transport_router::TransportRouter router(catalogue, {WAIT_TIME, VELOCITY});
+    ASSERT(!router.GetHierarchy().core.empty());
+
+    const std::string output = RunRequests(document, 1);
+    CheckAnswers(base, requests, json::Load(output).GetRoot().AsArray());
+    ASSERT(RunRequests(document, 4) == output);
+}
+
+// Ответы не зависят от того, пришли ли routing_settings до stat_requests или после.
+void TestLateRoutingSettings() {
+    const TestBase base = MakeTestBase(7, 50, 12);
+    const json::Array requests = MakeStatRequests(base);
+    std::string late = MakeRequestsDocument(base, -1, 0., requests);
+    late.pop_back();
+    late += ",\"routing_settings\":{\"bus_velocity\":"s + std::to_string(VELOCITY)
+          + ",\"bus_wait_time\":"s + std::to_string(WAIT_TIME) + "}}"s;
+    const std::string expected = RunRequests(MakeRequestsDocument(base, WAIT_TIME, VELOCITY, requests), 2);
+    ASSERT(RunRequests(late, 2) == expected);
+    ASSERT(RunRequests(late, 1) == expected);
+}
+
+// Без routing_settings запросам маршрутизации отвечает ошибка, остальным - как обычно.
+void TestMissingRoutingSettings() {
+    const TestBase base = MakeTestBase(8, 30, 8);
+    const json::Array requests = MakeStatRequests(base);
+    const json::Array answers = json::Load(RunRequests(MakeRequestsDocument(base, -1, 0., requests), 2))
+                                    .GetRoot().AsArray();
+    const ReferenceModel model(base);
+    ASSERT_EQUAL(answers.size(), requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const json::Dict& request = requests[i].AsMap();
+        const json::Dict& answer = answers[i].AsMap();
+        ASSERT(answer.at("request_id"s) == request.at("id"s));
+        if (request.count("max_distance"s) != 0) {
+            CheckReached(model.FindDistances(model.GetStopIndex(request.at("from"s).AsString())),
+                         request.at("max_distance"s).AsInt(), base, answer.at("stops"s).AsArray(), "distance"s);
+        } else {
+            ASSERT_EQUAL(answer.at("error_message"s).AsString(), "routing_settings are missing"s);
+        }
+    }
+}
+
+}  // namespace
+
+void RunRouterTests(TestRunner& runner) {
+    RUN_TEST(runner, TestRoutingMatchesDijkstra);
+    RUN_TEST(runner, TestDenseNetworkCore);
+    RUN_TEST(runner, TestLateRoutingSettings);
+    RUN_TEST(runner, TestMissingRoutingSettings);
+}
+
+}  // namespace tests
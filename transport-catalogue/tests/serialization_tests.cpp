@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "json_reader.h"
+#include "serialization.h"
+#include "test_data.h"
+#include "tests.h"
+#include "transport_router.h"
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+struct SavedBase {
+    transport_catalogue::TransportCatalogue catalogue;
+    serialization::SnapshotSettings settings;
+    std::string snapshot;
+};
+
+// Загружает тестовый справочник из JSON и сохраняет его снимок так же, как make_base.
+void MakeSnapshot(uint32_t seed, SavedBase& saved) {
+    const TestBase base = MakeTestBase(seed, 60, 12);
+    json_reader::JSONReader reader(saved.catalogue);
+    const json::Dict requests = reader.LoadRequests(MakeRequestsDocument(base, 6, 40., {}));
+    saved.settings.render_settings = map_renderer::RenderSettings(requests.at("render_settings"s).AsMap());
+    saved.settings.routing_settings = transport_router::GetRoutingSettings(requests.at("routing_settings"s).AsMap());
+    saved.settings.routing_hierarchy
+        = transport_router::TransportRouter(saved.catalogue, *saved.settings.routing_settings).GetHierarchy();
+    std::ostringstream output;
+    serialization::SaveSnapshot(saved.catalogue, saved.settings, output);
+    saved.snapshot = output.str();
+}
+
+template <typename Exception>
+bool Throws(std::string_view data) {
+    try {
+        transport_catalogue::TransportCatalogue catalogue;
+        serialization::LoadSnapshot(data, catalogue);
+    } catch (const Exception&) {
+        return true;
+    }
+    return false;
+}
+
+void TestSnapshotRoundTrip() {
+    SavedBase saved;
+    MakeSnapshot(1, saved);
+    const auto& expected = saved.catalogue;
+
+    transport_catalogue::TransportCatalogue loaded;
+    serialization::SnapshotSettings settings = serialization::LoadSnapshot(saved.snapshot, loaded);
+    ASSERT(loaded.IsFrozen());
+
+    ASSERT_EQUAL(loaded.GetStopCount(), expected.GetStopCount());
+    for (transport_catalogue::StopId id = 0; id < expected.GetStopCount(); ++id) {
+        ASSERT_EQUAL(loaded.GetStop(id).name, expected.GetStop(id).name);
+        ASSERT(std::memcmp(&loaded.GetStop(id).coord, &expected.GetStop(id).coord, sizeof(geo::Coordinates)) == 0);
+    }
+    ASSERT_EQUAL(loaded.GetRoadDistances().size(), expected.GetRoadDistances().size());
+    for (size_t i = 0; i < expected.GetRoadDistances().size(); ++i) {
+        const auto& lhs = loaded.GetRoadDistances()[i];
+        const auto& rhs = expected.GetRoadDistances()[i];
+        ASSERT(lhs.from == rhs.from && lhs.to == rhs.to && lhs.distance == rhs.distance);
+    }
+    ASSERT_EQUAL(loaded.GetBuses().size(), expected.GetBuses().size());
+    for (size_t i = 0; i < expected.GetBuses().size(); ++i) {
+        const auto& lhs = loaded.GetBuses()[i];
+        const auto& rhs = expected.GetBuses()[i];
+        ASSERT_EQUAL(lhs.name, rhs.name);
+        ASSERT_EQUAL(lhs.is_roundtrip, rhs.is_roundtrip);
+        const auto lhs_route = loaded.GetRoute(lhs);
+        const auto rhs_route = expected.GetRoute(rhs);
+        ASSERT(std::equal(lhs_route.begin(), lhs_route.end(), rhs_route.begin(), rhs_route.end()));
+        const auto& lhs_stat = loaded.GetBusStat(lhs);
+        const auto& rhs_stat = expected.GetBusStat(rhs);
+        ASSERT_EQUAL(lhs_stat.stop_count, rhs_stat.stop_count);
+        ASSERT_EQUAL(lhs_stat.unique_stop_count, rhs_stat.unique_stop_count);
+        ASSERT_EQUAL(lhs_stat.route_length, rhs_stat.route_length);
+        ASSERT_EQUAL(lhs_stat.curvature, rhs_stat.curvature);
+    }
+
+    ASSERT(settings.render_settings == saved.settings.render_settings);
+    ASSERT(settings.routing_settings == saved.settings.routing_settings);
+    ASSERT(settings.routing_hierarchy.has_value());
+
+    // Маршрутизатор из сохранённой иерархии отвечает так же, как построенный заново.
+    const transport_router::TransportRouter built(expected, *saved.settings.routing_settings);
+    const transport_router::TransportRouter restored(loaded, *settings.routing_settings,
+                                                     std::move(*settings.routing_hierarchy));
+    for (transport_catalogue::StopId from = 0; from < expected.GetStopCount(); from += 3) {
+        for (transport_catalogue::StopId to = 0; to < expected.GetStopCount(); to += 5) {
+            const auto lhs = restored.BuildRoute(loaded.GetStop(from).name, loaded.GetStop(to).name);
+            const auto rhs = built.BuildRoute(expected.GetStop(from).name, expected.GetStop(to).name);
+            ASSERT_EQUAL(lhs.has_value(), rhs.has_value());
+            if (lhs) {
+                ASSERT_EQUAL(lhs->total_time, rhs->total_time);
+                ASSERT_EQUAL(lhs->items.size(), rhs->items.size());
+            }
+        }
+    }
+
+    // Индексы, восстановленные из снимка, отвечают так же, как построенные.
+    for (transport_catalogue::StopId id = 0; id < expected.GetStopCount(); ++id) {
+        const auto& stop = expected.GetStop(id);
+        ASSERT_EQUAL(loaded.SearchStop(stop.name)->id, id);
+        const auto lhs = loaded.GetInfoAboutStop(stop.name);
+        const auto rhs = expected.GetInfoAboutStop(stop.name);
+        ASSERT(std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const auto* lhs, const auto* rhs) {
+            return lhs->id == rhs->id;
+        }));
+        const auto lhs_nearest = loaded.GetNearestStops(stop.coord, 4);
+        const auto rhs_nearest = expected.GetNearestStops(stop.coord, 4);
+        ASSERT_EQUAL(lhs_nearest.size(), rhs_nearest.size());
+        for (size_t i = 0; i < rhs_nearest.size(); ++i) {
+            ASSERT_EQUAL(lhs_nearest[i].first->id, rhs_nearest[i].first->id);
+        }
+    }
+    for (const auto& bus : expected.GetBuses()) {
+        ASSERT_EQUAL(loaded.SearchBus(bus.name)->id, bus.id);
+    }
+    ASSERT(loaded.SearchStop("no such stop"sv) == nullptr && loaded.SearchBus("no such bus"sv) == nullptr);
+
+    // Повторное сохранение даёт те же байты.
+    transport_catalogue::TransportCatalogue reloaded;
+    const serialization::SnapshotSettings reloaded_settings = serialization::LoadSnapshot(saved.snapshot, reloaded);
+    std::ostringstream output;
+    serialization::SaveSnapshot(reloaded, reloaded_settings, output);
+    ASSERT(output.str() == saved.snapshot);
+}
+
+void TestSnapshotWithoutSettings() {
+    SavedBase saved;
+    MakeSnapshot(2, saved);
+    std::ostringstream output;
+    serialization::SaveSnapshot(saved.catalogue, {}, output);
+
+    transport_catalogue::TransportCatalogue loaded;
+    const serialization::SnapshotSettings settings = serialization::LoadSnapshot(output.str(), loaded);
+    ASSERT(!settings.render_settings && !settings.routing_settings && !settings.routing_hierarchy);
+    ASSERT_EQUAL(loaded.GetBuses().size(), saved.catalogue.GetBuses().size());
+}
+
+void TestBrokenSnapshots() {
+    SavedBase saved;
+    MakeSnapshot(3, saved);
+    const std::string& snapshot = saved.snapshot;
+
+    ASSERT(!serialization::IsSnapshot("{}"sv));
+    ASSERT(Throws<std::runtime_error>("{\"base_requests\": []}"sv));
+    for (size_t size : {size_t{8}, size_t{20}, snapshot.size() / 2, snapshot.size() - 1}) {
+        ASSERT(Throws<std::runtime_error>(std::string_view(snapshot).substr(0, size)));
+    }
+    ASSERT(Throws<std::runtime_error>(snapshot + "x"s));
+
+    // Версия лежит сразу за сигнатурой и меткой порядка байтов.
+    std::string future = snapshot;
+    const uint32_t version = serialization::SNAPSHOT_VERSION + 1;
+    std::memcpy(future.data() + 12, &version, sizeof(version));
+    ASSERT(Throws<std::runtime_error>(future));
+
+    // Номер остановки в маршруте вне диапазона отвергается, справочник не меняется.
+    const auto route_stops = saved.catalogue.GetFrozenData().route_stops;
+    std::string route_bytes(sizeof(uint32_t) + route_stops.size() * sizeof(uint32_t), '\0');
+    const auto route_size = static_cast<uint32_t>(route_stops.size());
+    std::memcpy(route_bytes.data(), &route_size, sizeof(route_size));
+    std::memcpy(route_bytes.data() + sizeof(route_size), route_stops.data(), route_stops.size() * sizeof(uint32_t));
+    const size_t route_pos = snapshot.find(route_bytes);
+    ASSERT(route_pos != std::string::npos);
+    std::string corrupt = snapshot;
+    const auto bad_id = static_cast<uint32_t>(saved.catalogue.GetStopCount());
+    std::memcpy(corrupt.data() + route_pos + sizeof(route_size), &bad_id, sizeof(bad_id));
+    transport_catalogue::TransportCatalogue untouched;
+    untouched.AddStop("A"sv, {55., 37.});
+    untouched.Freeze();
+    bool is_rejected = false;
+    try {
+        serialization::LoadSnapshot(corrupt, untouched);
+    } catch (const std::runtime_error&) {
+        is_rejected = true;
+    }
+    ASSERT(is_rejected);
+    ASSERT_EQUAL(untouched.GetStopCount(), size_t{1});
+    ASSERT(untouched.SearchStop("A"sv) != nullptr);
+
+    // Иерархия, не согласованная с графом, не принимается.
+    graph::Router::Hierarchy hierarchy = *saved.settings.routing_hierarchy;
+    hierarchy.arcs.front().to ^= 1;
+    bool is_thrown = false;
+    try {
+        const transport_router::TransportRouter router(saved.catalogue, *saved.settings.routing_settings,
+                                                       std::move(hierarchy));
+    } catch (const std::invalid_argument&) {
+        is_thrown = true;
+    }
+    ASSERT(is_thrown);
+}
+
+}  // namespace
+
+void RunSerializationTests(TestRunner& runner) {
+    RUN_TEST(runner, TestSnapshotRoundTrip);
+    RUN_TEST(runner, TestSnapshotWithoutSettings);
+    RUN_TEST(runner, TestBrokenSnapshots);
+}
+
+}  // namespace tests
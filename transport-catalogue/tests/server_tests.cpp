@@ -0,0 +1,78 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "json_reader.h"
+#include "server.h"
+#include "tests.h"
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+const std::string_view BASE_WITHOUT_RENDER_SETTINGS = R"({
+    "base_requests": [
+        {"type": "Stop", "name": "A", "latitude": 55.60, "longitude": 37.60, "road_distances": {"B": 1000}},
+        {"type": "Stop", "name": "B", "latitude": 55.61, "longitude": 37.61, "road_distances": {}},
+        {"type": "Bus", "name": "1", "stops": ["A", "B"], "is_roundtrip": false}
+    ]
+})"sv;
+
+// Запоминает, сколько символов было записано к каждому сбросу потока.
+class FlushLog final : public std::stringbuf {
+public:
+    const std::vector<size_t>& GetFlushSizes() const {
+        return flush_sizes_;
+    }
+
+protected:
+    int sync() override {
+        flush_sizes_.push_back(view().size());
+        return 0;
+    }
+
+private:
+    std::vector<size_t> flush_sizes_;
+};
+
+// Map без настроек отрисовки получает свой ответ с ошибкой, остальные
+// запросы пакета выполняются, и каждый ответ уходит сразу, как готов.
+void TestServerAnswersEachRequest() {
+    transport_catalogue::TransportCatalogue catalogue;
+    json_reader::JSONReader reader(catalogue);
+    reader.LoadRequests(BASE_WITHOUT_RENDER_SETTINGS);
+    catalogue.Freeze();
+
+    std::istringstream input(
+        R"([{"id": 1, "type": "Stop", "name": "A"}, {"id": 2, "type": "Map"}, {"id": 3, "type": "Bus", "name": "1"}])"
+        "\n"s);
+    FlushLog buffer;
+    std::ostream output(&buffer);
+    std::ostringstream log;
+    server::Server server(reader, nullptr, log);
+    server.Serve(input, output);
+
+    const std::string text = buffer.str();
+    ASSERT(!text.empty() && text.back() == '\n');
+    const json::Array answers = json::Load(text).GetRoot().AsArray();
+    ASSERT_EQUAL(answers.size(), 3u);
+    ASSERT_EQUAL(answers[0].AsMap().at("request_id"s).AsInt(), 1);
+    ASSERT_EQUAL(answers[1].AsMap().at("error_message"s).AsString(), "render_settings are missing"s);
+    ASSERT_EQUAL(answers[1].AsMap().at("request_id"s).AsInt(), 2);
+    ASSERT_EQUAL(answers[2].AsMap().at("route_length"s).AsInt(), 2000);
+
+    // Первый ответ отправлен до того, как записан последний.
+    const auto& flushes = buffer.GetFlushSizes();
+    ASSERT(flushes.size() >= 3u);
+    ASSERT(flushes.front() > 1u && flushes.front() < text.find("route_length"sv));
+}
+
+}  // namespace
+
+void RunServerTests(TestRunner& runner) {
+    RUN_TEST(runner, TestServerAnswersEachRequest);
+}
+
+}  // namespace tests
@@ -0,0 +1,120 @@
+#include "test_data.h"
+
+#include <random>
+#include <sstream>
+
+using namespace std::literals;
+
+namespace tests {
+
+namespace {
+
+json::Dict MakeRenderSettings() {
+    return json::Dict{
+        {"width"s, 600.},
+        {"height"s, 400.},
+        {"padding"s, 50.},
+        {"line_width"s, 14.},
+        {"stop_radius"s, 5.},
+        {"bus_label_font_size"s, 20},
+        {"bus_label_offset"s, json::Array{7., 15.}},
+        {"stop_label_font_size"s, 20},
+        {"stop_label_offset"s, json::Array{7., -3.}},
+        {"underlayer_color"s, json::Array{255, 255, 255, 0.85}},
+        {"underlayer_width"s, 3.},
+        {"color_palette"s, json::Array{"green"s, json::Array{255, 160, 0}, "red"s}},
+    };
+}
+
+}  // namespace
+
+TestBase MakeTestBase(uint32_t seed, int stop_count, int bus_count) {
+    std::mt19937 generator(seed);
+    auto random_int = [&generator](int min, int max) {
+        return std::uniform_int_distribution<int>(min, max)(generator);
+    };
+    std::uniform_real_distribution<double> offset(-0.05, 0.05);
+
+    TestBase base;
+    for (int i = 0; i < stop_count; ++i) {
+        base.stop_names.push_back("Stop "s + std::to_string(i));
+    }
+    for (int i = 0; i < bus_count; ++i) {
+        TestBase::Bus bus;
+        bus.name = std::to_string(i) + (i % 2 == 0 ? "k"s : ""s);
+        bus.is_roundtrip = i % 3 == 0;
+        const int length = random_int(2, 12);
+        for (int j = 0; j < length; ++j) {
+            bus.stops.push_back(random_int(0, stop_count - 1));
+        }
+        if (bus.is_roundtrip) {
+            bus.stops.push_back(bus.stops.front());
+        }
+        base.buses.push_back(std::move(bus));
+    }
+
+    // Расстояние задаётся для каждого перегона хотя бы в одну сторону: второе
+    // направление справочник берёт из первого.
+    std::vector<json::Dict> road_distances(stop_count);
+    auto set_distance = [&](int from, int to) {
+        road_distances[from].insert({base.stop_names[to], random_int(100, 5000)});
+    };
+    for (const auto& bus : base.buses) {
+        for (size_t j = 0; j + 1 < bus.stops.size(); ++j) {
+            const int from = bus.stops[j];
+            const int to = bus.stops[j + 1];
+            switch (random_int(0, 2)) {
+                case 0:
+                    set_distance(from, to);
+                    break;
+                case 1:
+                    set_distance(to, from);
+                    break;
+                default:
+                    set_distance(from, to);
+                    set_distance(to, from);
+            }
+        }
+    }
+
+    for (int i = 0; i < stop_count; ++i) {
+        base.base_requests.push_back(json::Dict{
+            {"type"s, "Stop"s},
+            {"name"s, base.stop_names[i]},
+            {"latitude"s, 55.75 + offset(generator)},
+            {"longitude"s, 37.6 + offset(generator)},
+            {"road_distances"s, road_distances[i]},
+        });
+    }
+    for (const auto& bus : base.buses) {
+        json::Array stops;
+        for (int stop : bus.stops) {
+            stops.push_back(base.stop_names[stop]);
+        }
+        base.base_requests.push_back(json::Dict{
+            {"type"s, "Bus"s},
+            {"name"s, bus.name},
+            {"stops"s, std::move(stops)},
+            {"is_roundtrip"s, bus.is_roundtrip},
+        });
+    }
+    return base;
+}
+
+std::string MakeRequestsDocument(const TestBase& base, int bus_wait_time, double bus_velocity,
+                                 const json::Array& stat_requests) {
+    json::Dict document{
+        {"base_requests"s, base.base_requests},
+        {"render_settings"s, MakeRenderSettings()},
+        {"stat_requests"s, stat_requests},
+    };
+    if (bus_wait_time >= 0) {
+        document.insert({"routing_settings"s, json::Dict{{"bus_wait_time"s, bus_wait_time},
+                                                         {"bus_velocity"s, bus_velocity}}});
+    }
+    std::ostringstream output;
+    json::Print(json::Document{std::move(document)}, output);
+    return output.str();
+}
+
+}  // namespace tests
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "json.h"
+
+namespace tests {
+
+// Случайный справочник для тестов: остановки в окрестности одной точки и
+// автобусы, кольцевые и нет, с расстояниями для всех перегонов. Часть
+// расстояний задана только в одну сторону, чтобы проверялась и подстановка
+// обратного направления.
+struct TestBase {
+    // Маршруты в том виде, в каком они заданы в base_requests.
+    struct Bus {
+        std::string name;
+        std::vector<int> stops;
+        bool is_roundtrip = false;
+    };
+
+    std::vector<std::string> stop_names;
+    std::vector<Bus> buses;
+    json::Array base_requests;
+};
+
+TestBase MakeTestBase(uint32_t seed, int stop_count, int bus_count);
+
+// Полный документ запроса: base_requests, render_settings, routing_settings
+// (если bus_wait_time >= 0) и переданные stat_requests.
+std::string MakeRequestsDocument(const TestBase& base, int bus_wait_time, double bus_velocity,
+                                 const json::Array& stat_requests);
+
+}  // namespace tests
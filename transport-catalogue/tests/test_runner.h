@@ -0,0 +1,55 @@
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace tests {
+
+// Проверки выбрасывают std::runtime_error с местом и текстом условия;
+// TestRunner ловит его, печатает и считает упавшие тесты.
+#define ASSERT(expr)                                                                  \
+    do {                                                                              \
+        if (!(expr)) {                                                                \
+            throw std::runtime_error(std::string(__FILE__) + ":" + std::to_string(__LINE__) \
+                                     + ": ASSERT(" #expr ") failed");                 \
+        }                                                                             \
+    } while (false)
+
+#define ASSERT_EQUAL(lhs, rhs)                                                        \
+    do {                                                                              \
+        const auto& lhs_value = (lhs);                                                \
+        const auto& rhs_value = (rhs);                                                \
+        if (!(lhs_value == rhs_value)) {                                              \
+            std::ostringstream message;                                               \
+            message << __FILE__ << ":" << __LINE__ << ": " #lhs " != " #rhs ": "     \
+                    << lhs_value << " != " << rhs_value;                              \
+            throw std::runtime_error(message.str());                                  \
+        }                                                                             \
+    } while (false)
+
+#define RUN_TEST(runner, test) (runner).Run(test, #test)
+
+class TestRunner {
+public:
+    template <typename Test>
+    void Run(Test test, const std::string& name) {
+        try {
+            test();
+            std::cerr << name << " OK\n";
+        } catch (const std::exception& e) {
+            ++failed_count_;
+            std::cerr << name << " FAILED: " << e.what() << '\n';
+        }
+    }
+
+    int GetFailedCount() const {
+        return failed_count_;
+    }
+
+private:
+    int failed_count_ = 0;
+};
+
+}  // namespace tests
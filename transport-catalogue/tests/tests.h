@@ -0,0 +1,14 @@
+#pragma once
+
+#include "test_runner.h"
+
+namespace tests {
+
+void RunJsonTests(TestRunner& runner);
+void RunCatalogueTests(TestRunner& runner);
+void RunSerializationTests(TestRunner& runner);
+void RunRouterTests(TestRunner& runner);
+void RunRenderTests(TestRunner& runner);
+void RunServerTests(TestRunner& runner);
+
+}  // namespace tests
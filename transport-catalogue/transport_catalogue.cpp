@@ -1,70 +1,508 @@
 #include "transport_catalogue.h"
 
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
 
 namespace transport_catalogue{
     
-void TransportCatalogue::AddBus(std::string&& busname, const std::vector<std::string_view>& stops){
-    Bus bus;
-    bus.name = std::move(busname);
+namespace {
+    
+void Bind(std::vector<uint32_t>& name_to_id, NameId name, uint32_t id, uint32_t no_id) {
+    if (name_to_id.size() <= name) {
+        name_to_id.resize(name + 1, no_id);
+    }
+    name_to_id[name] = id;
+}
+
+bool IsBelow(const std::vector<uint32_t>& ids, size_t bound) {
+    return std::all_of(ids.begin(), ids.end(), [bound](uint32_t id) {
+        return id < bound;
+    });
+}
+
+// Смещения списков смежности для count списков общей длиной size.
+bool IsValidOffsets(const std::vector<uint32_t>& offsets, size_t count, size_t size) {
+    return offsets.size() == count + 1 && offsets.front() == 0 && offsets.back() == size
+        && std::is_sorted(offsets.begin(), offsets.end());
+}
+    
+}  // namespace
+    
+void TransportCatalogue::AddBus(std::string_view busname, const std::vector<std::string_view>& stops, bool is_roundtrip){
+    AddBusName(busname, is_roundtrip);
     for (const auto& stopname : stops) {
-        if (stopname_to_stop_.count(stopname)) {
-            bus.stops.push_back(stopname_to_stop_.at(stopname));
+        if (const Stop* stop = SearchStop(stopname); stop != nullptr) {
+            route_stops_.push_back(stop->id);
         }
     }
-    buses_.push_back(std::move(bus));
-    busname_to_stop_[buses_.back().name] = &buses_.back();
-    for (const Stop* stopname : buses_.back().stops){
-        stopname_to_bus_[(*stopname).name].insert(&buses_.back());
+    route_offsets_.push_back(static_cast<uint32_t>(route_stops_.size()));
+}
+
+void TransportCatalogue::AddBus(std::string_view busname, std::span<const StopId> stops, bool is_roundtrip){
+    AddBusName(busname, is_roundtrip);
+    for (StopId id : stops) {
+        if (id < stops_.size()) {
+            route_stops_.push_back(id);
+        }
     }
+    route_offsets_.push_back(static_cast<uint32_t>(route_stops_.size()));
 }
 
-void TransportCatalogue::AddStop(std::string&& stopname, geo::Coordinates coordinates){
-    Stop stop = {stopname, coordinates};
-    stops_.push_back(std::move(stop));
-    stopname_to_stop_[stops_.back().name] = &stops_.back();
-    stopname_to_bus_[stops_.back().name] = {};
+void TransportCatalogue::AddBusName(std::string_view busname, bool is_roundtrip){
+    const NameId name = names_.Intern(busname);
+    Bus bus;
+    bus.name = names_.GetName(name);
+    bus.is_roundtrip = is_roundtrip;
+    bus.id = static_cast<BusId>(buses_.size());
+    is_frozen_ = false;
+    ++version_;
+    buses_.push_back(bus);
+    Bind(name_to_bus_, name, bus.id, NO_ID);
+}
+
+const Stop* TransportCatalogue::AddStop(std::string_view stopname, geo::Coordinates coordinates){
+    is_frozen_ = false;
+    ++version_;
+    const NameId name = names_.Intern(stopname);
+    Stop stop = {names_.GetName(name), coordinates, static_cast<StopId>(stops_.size())};
+    stops_.push_back(stop);
+    stop_coords_.push_back(coordinates);
+    stop_trig_.Add(coordinates);
+    Bind(name_to_stop_, name, stop.id, NO_ID);
+    return &stops_.back();
 }
 
 const Bus* TransportCatalogue::SearchBus(std::string_view busname) const{
-    
-    if(!busname_to_stop_.count(busname)){
+    if (is_frozen_) {
+        const BusId id = bus_index_.Find(busname, NamePool::Hash(busname));
+        return id != PerfectHashIndex::NOT_FOUND ? &buses_[id] : nullptr;
+    }
+    const NameId name = names_.Find(busname);
+    if(name >= name_to_bus_.size() || name_to_bus_[name] == NO_ID){
         return nullptr;
     }
-    return busname_to_stop_.at(busname);
+    return &buses_[name_to_bus_[name]];
 }
 
 const Stop* TransportCatalogue::SearchStop(std::string_view stopname) const{ 
-    if(!stopname_to_stop_.count(stopname)){
+    if (is_frozen_) {
+        const StopId id = stop_index_.Find(stopname, NamePool::Hash(stopname));
+        return id != PerfectHashIndex::NOT_FOUND ? &stops_[id] : nullptr;
+    }
+    const NameId name = names_.Find(stopname);
+    if(name >= name_to_stop_.size() || name_to_stop_[name] == NO_ID){
         return nullptr;
     }
-    return stopname_to_stop_.at(stopname);
+    return &stops_[name_to_stop_[name]];
 }
 
 std::vector<const Stop*> TransportCatalogue::GetInfoAboutBus(std::string_view busname) const{
     const Bus* pbus = SearchBus(busname);
-    if (pbus != nullptr){
-        return (*pbus).stops;
+    if (pbus == nullptr){
+        return {};
+    }
+    std::vector<const Stop*> result;
+    for (StopId id : GetRoute(*pbus)) {
+        result.push_back(&stops_[id]);
     }
-    return {};
+    return result;
 }
 
-std::set<const Bus*> TransportCatalogue::GetInfoAboutStop(std::string_view stopname) const{
+std::span<const Bus* const> TransportCatalogue::GetInfoAboutStop(std::string_view stopname) const{
     const Stop* pstop = SearchStop(stopname);
-    if (pstop != nullptr && !stopname_to_bus_.at(stopname).empty()){
-        return stopname_to_bus_.at(stopname);
+    if (pstop == nullptr){
+        return {};
+    }
+    return GetBusesByStop(*pstop);
+}
+
+std::span<const Bus* const> TransportCatalogue::GetBusesByStop(const Stop& stop) const{
+    return std::span<const Bus* const>(stop_buses_).subspan(stop_bus_offsets_[stop.id],
+                                                            stop_bus_offsets_[stop.id + 1] - stop_bus_offsets_[stop.id]);
+}
+
+std::vector<const Stop*> TransportCatalogue::GetStopsInBox(geo::Coordinates min, geo::Coordinates max) const {
+    std::vector<const Stop*> result;
+    for (StopId id : stop_spatial_index_.FindInBox(min, max)) {
+        result.push_back(&stops_[id]);
+    }
+    std::sort(result.begin(), result.end(), [](const Stop* lhs, const Stop* rhs) {
+        return lhs->name < rhs->name;
+    });
+    return result;
+}
+
+std::vector<std::pair<const Stop*, double>> TransportCatalogue::GetNearestStops(geo::Coordinates point,
+                                                                                size_t count) const {
+    std::vector<std::pair<const Stop*, double>> result;
+    for (const auto& [id, distance] : stop_spatial_index_.FindNearest(point, count)) {
+        result.emplace_back(&stops_[id], distance);
     }
-    return {};
+    return result;
 }
 
 void TransportCatalogue::AddDistanceStops(std::string_view lhs, std::string_view rhs, int distance) {
-    distance_[{SearchStop(lhs), SearchStop(rhs)}] = distance;
+    const Stop* from = SearchStop(lhs);
+    const Stop* to = SearchStop(rhs);
+    if (from == nullptr || to == nullptr) {
+        return;
+    }
+    is_frozen_ = false;
+    ++version_;
+    road_distances_.push_back({from->id, to->id, distance});
+}
+
+void TransportCatalogue::AddDistanceStops(StopId from, StopId to, int distance) {
+    if (from >= stops_.size() || to >= stops_.size()) {
+        return;
+    }
+    is_frozen_ = false;
+    ++version_;
+    road_distances_.push_back({from, to, distance});
 }
 
 int TransportCatalogue::GetDistanceStops(std::string_view lhs, std::string_view rhs) const {
-    if (distance_.count({ SearchStop(lhs) , SearchStop(rhs) })) {
-        return distance_.at({ SearchStop(lhs) , SearchStop(rhs) });
+    const Stop* from = SearchStop(lhs);
+    const Stop* to = SearchStop(rhs);
+    if (from == nullptr || to == nullptr) {
+        throw std::out_of_range("Unknown stop"s);
+    }
+    return GetDistanceStops(from->id, to->id);
+}
+
+int TransportCatalogue::GetDistanceStops(StopId from, StopId to) const {
+    if (!is_frozen_) {
+        throw std::logic_error("Catalogue must be frozen before distance queries"s);
+    }
+    if (const int* distance = FindDistance(from, to); distance != nullptr) {
+        return *distance;
+    }
+    throw std::out_of_range("Distance between stops is not set"s);
+}
+
+const int* TransportCatalogue::FindDistance(StopId from, StopId to) const {
+    if (const int* distance = FindDirectedDistance(from, to); distance != nullptr) {
+        return distance;
+    }
+    return FindDirectedDistance(to, from);
+}
+
+const int* TransportCatalogue::FindDirectedDistance(StopId from, StopId to) const {
+    const auto begin = distance_targets_.begin() + distance_offsets_[from];
+    const auto end = distance_targets_.begin() + distance_offsets_[from + 1];
+    const auto it = std::lower_bound(begin, end, to);
+    if (it == end || *it != to) {
+        return nullptr;
+    }
+    return &distance_values_[it - distance_targets_.begin()];
+}
+
+std::span<const int> TransportCatalogue::GetRouteDistances(const Bus& bus) const {
+    const auto route = GetRoute(bus);
+    if (route.empty()) {
+        return {};
+    }
+    return std::span<const int>(route_distances_).subspan(route_offsets_[bus.id], route.size() - 1);
+}
+
+void TransportCatalogue::Freeze() {
+    BuildDistanceIndex();
+    BuildRouteDistances();
+    BuildRouteLinks();
+    BuildBusStats();
+    BuildStopBuses();
+    stop_spatial_index_.Build(stop_coords_);
+    BuildNameIndex(stop_index_, name_to_stop_);
+    BuildNameIndex(bus_index_, name_to_bus_);
+    is_frozen_ = true;
+}
+
+void TransportCatalogue::BuildDistanceIndex() {
+    // При повторном задании расстояния между теми же остановками действует последнее.
+    std::stable_sort(road_distances_.begin(), road_distances_.end(), [](const RoadDistance& lhs, const RoadDistance& rhs) {
+        return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+    });
+    
+    distance_offsets_.assign(stops_.size() + 1, 0);
+    distance_targets_.clear();
+    distance_values_.clear();
+    for (size_t i = 0; i < road_distances_.size(); ++i) {
+        const RoadDistance& road = road_distances_[i];
+        if (i + 1 < road_distances_.size() && road_distances_[i + 1].from == road.from
+            && road_distances_[i + 1].to == road.to) {
+            continue;
+        }
+        ++distance_offsets_[road.from + 1];
+        distance_targets_.push_back(road.to);
+        distance_values_.push_back(road.distance);
+    }
+    for (size_t id = 0; id < stops_.size(); ++id) {
+        distance_offsets_[id + 1] += distance_offsets_[id];
     }
-    return distance_.at({ SearchStop(rhs) , SearchStop(lhs) });
 }
 
-}
\ No newline at end of file
+void TransportCatalogue::BuildRouteDistances() {
+    // Статистика заводится здесь, чтобы отметить маршруты без расстояний;
+    // остальное в ней заполняет BuildBusStats.
+    bus_stats_.assign(buses_.size(), {});
+    route_distances_.assign(route_stops_.size(), 0);
+    for (const Bus& bus : buses_) {
+        const auto route = GetRoute(bus);
+        const size_t offset = route_offsets_[bus.id];
+        for (size_t i = 0; i + 1 < route.size(); ++i) {
+            if (const int* distance = FindDistance(route[i], route[i + 1]); distance != nullptr) {
+                route_distances_[offset + i] = *distance;
+            } else {
+                bus_stats_[bus.id].has_road_distances = false;
+            }
+        }
+    }
+}
+
+void TransportCatalogue::BuildRouteLinks() {
+    std::vector<RoadDistance> links;
+    links.reserve(route_stops_.size());
+    for (const Bus& bus : buses_) {
+        if (!bus_stats_[bus.id].has_road_distances) {
+            continue;
+        }
+        const auto route = GetRoute(bus);
+        const size_t offset = route_offsets_[bus.id];
+        for (size_t i = 0; i + 1 < route.size(); ++i) {
+            if (route[i] != route[i + 1]) {
+                links.push_back({route[i], route[i + 1], route_distances_[offset + i]});
+            }
+        }
+    }
+    std::sort(links.begin(), links.end(), [](const RoadDistance& lhs, const RoadDistance& rhs) {
+        return std::tie(lhs.from, lhs.to, lhs.distance) < std::tie(rhs.from, rhs.to, rhs.distance);
+    });
+    
+    route_link_offsets_.assign(stops_.size() + 1, 0);
+    route_links_.clear();
+    for (size_t i = 0; i < links.size(); ++i) {
+        if (i != 0 && links[i - 1].from == links[i].from && links[i - 1].to == links[i].to) {
+            continue;
+        }
+        route_links_.push_back({links[i].to, links[i].distance});
+        ++route_link_offsets_[links[i].from + 1];
+    }
+    for (size_t id = 0; id < stops_.size(); ++id) {
+        route_link_offsets_[id + 1] += route_link_offsets_[id];
+    }
+}
+
+void TransportCatalogue::FindReachableStops(StopId from, int max_distance,
+                                            std::vector<std::pair<StopId, int>>& reached) const {
+    graph::FindWithin(stops_.size(), from, max_distance,
+                      [this](StopId id, const auto& relax) {
+                          for (const auto& [to, distance] : GetRouteLinks(id)) {
+                              relax(to, distance);
+                          }
+                      },
+                      reached);
+}
+
+void TransportCatalogue::BuildBusStats() {
+    // Номер автобуса, на котором остановка встретилась последний раз, плюс один.
+    std::vector<uint32_t> last_seen(stops_.size(), 0);
+    for (const Bus& bus : buses_) {
+        const auto route = GetRoute(bus);
+        BusStat& stat = bus_stats_[bus.id];
+        stat.stop_count = static_cast<int>(route.size());
+        for (StopId id : route) {
+            if (last_seen[id] != bus.id + 1) {
+                last_seen[id] = bus.id + 1;
+                ++stat.unique_stop_count;
+            }
+        }
+        stat.geo_length = stop_trig_.ComputeRouteLength(route);
+        if (!stat.has_road_distances) {
+            continue;
+        }
+        for (int distance : GetRouteDistances(bus)) {
+            stat.route_length += distance;
+        }
+        stat.curvature = static_cast<double>(stat.route_length) / stat.geo_length;
+    }
+}
+
+const BusStat* TransportCatalogue::GetBusStat(std::string_view busname) const {
+    const Bus* bus = SearchBus(busname);
+    if (bus == nullptr) {
+        return nullptr;
+    }
+    return &GetBusStat(*bus);
+}
+
+void TransportCatalogue::BuildStopBuses() {
+    std::vector<const Bus*> sorted_buses;
+    sorted_buses.reserve(buses_.size());
+    for (const Bus& bus : buses_) {
+        sorted_buses.push_back(&bus);
+    }
+    std::sort(sorted_buses.begin(), sorted_buses.end(), [](const Bus* lhs, const Bus* rhs) {
+        return lhs->name < rhs->name;
+    });
+    
+    // Первый проход считает автобусы каждой остановки, второй раскладывает их
+    // по местам. Автобусы перебираются по названию, поэтому списки уже упорядочены.
+    std::vector<uint32_t> last_seen(stops_.size(), 0);
+    stop_bus_offsets_.assign(stops_.size() + 1, 0);
+    for (const Bus* bus : sorted_buses) {
+        for (StopId id : GetRoute(*bus)) {
+            if (last_seen[id] != bus->id + 1) {
+                last_seen[id] = bus->id + 1;
+                ++stop_bus_offsets_[id + 1];
+            }
+        }
+    }
+    for (size_t id = 0; id < stops_.size(); ++id) {
+        stop_bus_offsets_[id + 1] += stop_bus_offsets_[id];
+    }
+    
+    std::vector<uint32_t> positions(stop_bus_offsets_.begin(), stop_bus_offsets_.end() - 1);
+    std::fill(last_seen.begin(), last_seen.end(), 0);
+    stop_buses_.assign(stop_bus_offsets_.back(), nullptr);
+    for (const Bus* bus : sorted_buses) {
+        for (StopId id : GetRoute(*bus)) {
+            if (last_seen[id] != bus->id + 1) {
+                last_seen[id] = bus->id + 1;
+                stop_buses_[positions[id]++] = bus;
+            }
+        }
+    }
+}
+
+void TransportCatalogue::BuildNameIndex(PerfectHashIndex& index, const std::vector<uint32_t>& name_to_id) const {
+    std::vector<std::string_view> keys;
+    std::vector<size_t> hashes;
+    std::vector<uint32_t> values;
+    for (NameId name = 0; name < name_to_id.size(); ++name) {
+        if (name_to_id[name] != NO_ID) {
+            keys.push_back(names_.GetName(name));
+            hashes.push_back(names_.GetHash(name));
+            values.push_back(name_to_id[name]);
+        }
+    }
+    index.Build(keys, hashes, values);
+}
+
+TransportCatalogue::FrozenData TransportCatalogue::GetFrozenData() const {
+    if (!is_frozen_) {
+        throw std::logic_error("Catalogue must be frozen before export"s);
+    }
+    FrozenData data;
+    data.names = names_.GetContents();
+    for (const Stop& stop : stops_) {
+        data.stop_names.push_back(names_.Find(stop.name));
+    }
+    data.stop_coords = stop_coords_;
+    data.stop_trig = stop_trig_.GetColumns();
+    data.stop_spatial_index = stop_spatial_index_.GetContents();
+    for (const Bus& bus : buses_) {
+        data.bus_names.push_back(names_.Find(bus.name));
+        data.bus_is_roundtrip.push_back(bus.is_roundtrip);
+    }
+    data.route_offsets = route_offsets_;
+    data.route_stops = route_stops_;
+    data.road_distances = road_distances_;
+    data.distance_offsets = distance_offsets_;
+    data.distance_targets = distance_targets_;
+    data.distance_values = distance_values_;
+    data.route_distances = route_distances_;
+    data.route_link_offsets = route_link_offsets_;
+    data.route_links = route_links_;
+    data.bus_stats = bus_stats_;
+    data.stop_bus_offsets = stop_bus_offsets_;
+    for (const Bus* bus : stop_buses_) {
+        data.stop_buses.push_back(bus->id);
+    }
+    data.stop_index = stop_index_.GetTable();
+    data.bus_index = bus_index_.GetTable();
+    return data;
+}
+
+void TransportCatalogue::Restore(FrozenData data) {
+    // Всё собирается в отдельном справочнике, чтобы при ошибке этот не менялся.
+    TransportCatalogue restored;
+    restored.names_.Restore(std::move(data.names));
+    const size_t name_count = restored.names_.GetSize();
+    const size_t stop_count = data.stop_names.size();
+    const size_t bus_count = data.bus_names.size();
+    const auto has_valid_ends = [stop_count](const auto& items) {
+        return std::all_of(items.begin(), items.end(), [stop_count](const auto& item) {
+            return item.to < stop_count;
+        });
+    };
+    const bool is_valid = IsBelow(data.stop_names, name_count) && data.stop_coords.size() == stop_count
+        && IsBelow(data.bus_names, name_count) && data.bus_is_roundtrip.size() == bus_count
+        && IsValidOffsets(data.route_offsets, bus_count, data.route_stops.size())
+        && IsBelow(data.route_stops, stop_count)
+        && has_valid_ends(data.road_distances)
+        && std::all_of(data.road_distances.begin(), data.road_distances.end(), [stop_count](const RoadDistance& road) {
+               return road.from < stop_count;
+           })
+        && IsValidOffsets(data.distance_offsets, stop_count, data.distance_targets.size())
+        && data.distance_values.size() == data.distance_targets.size() && IsBelow(data.distance_targets, stop_count)
+        && data.route_distances.size() == data.route_stops.size()
+        && IsValidOffsets(data.route_link_offsets, stop_count, data.route_links.size())
+        && has_valid_ends(data.route_links) && data.bus_stats.size() == bus_count
+        && IsValidOffsets(data.stop_bus_offsets, stop_count, data.stop_buses.size())
+        && IsBelow(data.stop_buses, bus_count);
+    if (!is_valid) {
+        throw std::invalid_argument("Frozen catalogue data is inconsistent"s);
+    }
+
+    restored.stop_trig_.Restore(std::move(data.stop_trig));
+    if (restored.stop_trig_.GetSize() != stop_count) {
+        throw std::invalid_argument("Frozen catalogue data is inconsistent"s);
+    }
+    restored.stop_spatial_index_.Restore(std::move(data.stop_spatial_index), stop_count);
+
+    std::vector<std::string_view> stop_keys;
+    std::vector<size_t> stop_hashes;
+    for (StopId id = 0; id < stop_count; ++id) {
+        const NameId name = data.stop_names[id];
+        restored.stops_.push_back({restored.names_.GetName(name), data.stop_coords[id], id});
+        Bind(restored.name_to_stop_, name, id, NO_ID);
+        stop_keys.push_back(restored.names_.GetName(name));
+        stop_hashes.push_back(restored.names_.GetHash(name));
+    }
+    std::vector<std::string_view> bus_keys;
+    std::vector<size_t> bus_hashes;
+    for (BusId id = 0; id < bus_count; ++id) {
+        const NameId name = data.bus_names[id];
+        restored.buses_.push_back({restored.names_.GetName(name), data.bus_is_roundtrip[id] != 0, id});
+        Bind(restored.name_to_bus_, name, id, NO_ID);
+        bus_keys.push_back(restored.names_.GetName(name));
+        bus_hashes.push_back(restored.names_.GetHash(name));
+    }
+    restored.stop_index_.Restore(std::move(data.stop_index), stop_keys, stop_hashes);
+    restored.bus_index_.Restore(std::move(data.bus_index), bus_keys, bus_hashes);
+
+    restored.stop_coords_ = std::move(data.stop_coords);
+    restored.route_offsets_ = std::move(data.route_offsets);
+    restored.route_stops_ = std::move(data.route_stops);
+    restored.road_distances_ = std::move(data.road_distances);
+    restored.distance_offsets_ = std::move(data.distance_offsets);
+    restored.distance_targets_ = std::move(data.distance_targets);
+    restored.distance_values_ = std::move(data.distance_values);
+    restored.route_distances_ = std::move(data.route_distances);
+    restored.route_link_offsets_ = std::move(data.route_link_offsets);
+    restored.route_links_ = std::move(data.route_links);
+    restored.bus_stats_ = std::move(data.bus_stats);
+    restored.stop_bus_offsets_ = std::move(data.stop_bus_offsets);
+    for (BusId id : data.stop_buses) {
+        restored.stop_buses_.push_back(&restored.buses_[id]);
+    }
+    restored.is_frozen_ = true;
+    restored.version_ = version_ + 1;
+    // Перемещение пула и деков не двигает ни строки, ни автобусы, поэтому
+    // указатели на них остаются действительными.
+    *this = std::move(restored);
+}
+
+}
@@ -1,42 +1,77 @@
 #pragma once
 #include<algorithm>
+#include<cstdint>
 #include<deque>
+#include<limits>
+#include<span>
 #include<string>
 #include<string_view>
-#include<unordered_map>
-#include<set>
 #include<vector>
 
 #include "geo.h"
+#include "graph.h"
+#include "name_pool.h"
+#include "perfect_hash.h"
+#include "spatial_index.h"
 
 using namespace std::literals;
 
 
 namespace transport_catalogue{
+
+// Остановки и автобусы нумеруются подряд с нуля в порядке добавления.
+using StopId = uint32_t;
+using BusId = uint32_t;
     
+// Названия остановок и автобусов принадлежат пулу справочника.
 struct Stop{
-    std::string name;
+    std::string_view name;
     geo::Coordinates coord;
+    StopId id = 0;
 };
 
 struct Bus{
-    std::string name;
-    std::vector<const Stop*> stops;
+    std::string_view name;
+    bool is_roundtrip = false;
+    BusId id = 0;
 }; 
 
-struct StopDistanceHasher {
-    size_t operator()(const std::pair<const Stop*, const Stop*>& distance) const {
-        size_t first_hash = std::hash<const void*>{}(distance.first);
-        size_t second_hash = std::hash<const void*>{}(distance.second);
-        return first_hash + second_hash*37;
-    }
+struct BusStat{
+    // false, если хотя бы для одного перегона расстояние по дороге не задано
+    // ни в одну сторону: длина маршрута и извилистость тогда не определены.
+    bool has_road_distances = true;
+    int stop_count = 0;
+    int unique_stop_count = 0;
+    int route_length = 0;
+    double geo_length = 0.;
+    double curvature = 0.;
+};
+
+// Расстояние по дороге от одной остановки до другой в том виде, в каком его задали.
+struct RoadDistance {
+    StopId from;
+    StopId to;
+    int distance;
+};
+
+// Перегон от остановки до следующей по маршруту хотя бы одного автобуса.
+struct RouteLink {
+    StopId to;
+    int distance;
 };
 
+// Справочник заполняется методами Add*, после чего вызывается Freeze(): он
+// строит индексы только для чтения, на которые опираются запросы расстояний,
+// статистика и поиск по названию. Любое последующее изменение снимает
+// заморозку до следующего Freeze().
 class TransportCatalogue {
 public:
-    void AddBus(std::string&& busname, const std::vector<std::string_view>& stops);
+    void AddBus(std::string_view busname, const std::vector<std::string_view>& stops, bool is_roundtrip);
     
-    void AddStop(std::string&& stopname, geo::Coordinates coordinates);
+    // Маршрут задан идентификаторами остановок; несуществующие пропускаются.
+    void AddBus(std::string_view busname, std::span<const StopId> stops, bool is_roundtrip);
+    
+    const Stop* AddStop(std::string_view stopname, geo::Coordinates coordinates);
    
     const Bus* SearchBus(std::string_view busname) const;
     
@@ -44,21 +79,183 @@ public:
     
     std::vector<const Stop*> GetInfoAboutBus(std::string_view busname) const;
     
-    std::set<const Bus*> GetInfoAboutStop(std::string_view stopname) const;
+    // Автобусы, проходящие через остановку, упорядоченные по названию.
+    // Доступны после Freeze(); для неизвестной остановки список пуст.
+    std::span<const Bus* const> GetInfoAboutStop(std::string_view stopname) const;
+    
+    std::span<const Bus* const> GetBusesByStop(const Stop& stop) const;
+    
+    // Статистика маршрута, посчитанная при Freeze(); nullptr, если автобуса нет.
+    const BusStat* GetBusStat(std::string_view busname) const;
+    
+    const BusStat& GetBusStat(const Bus& bus) const {
+        return bus_stats_[bus.id];
+    }
+
+    // Остановки внутри прямоугольника координат, границы включаются; по названию.
+    // Доступны после Freeze().
+    std::vector<const Stop*> GetStopsInBox(geo::Coordinates min, geo::Coordinates max) const;
+    
+    // Не больше count ближайших к точке остановок с расстоянием по прямой в метрах,
+    // ближние первыми. Доступны после Freeze().
+    std::vector<std::pair<const Stop*, double>> GetNearestStops(geo::Coordinates point, size_t count) const;
+
+    // Перегоны, выходящие из остановки, без повторов, по возрастанию StopId;
+    // из нескольких перегонов к одной остановке остаётся кратчайший.
+    // Доступны после Freeze().
+    std::span<const RouteLink> GetRouteLinks(StopId id) const {
+        return std::span<const RouteLink>(route_links_).subspan(route_link_offsets_[id],
+                                                               route_link_offsets_[id + 1] - route_link_offsets_[id]);
+    }
+    
+    // Остановки, до которых можно доехать от from по маршрутам автобусов, проехав
+    // по дорогам не больше max_distance метров, с этим расстоянием, ближние первыми.
+    // reached переиспользуется между вызовами. Доступны после Freeze().
+    void FindReachableStops(StopId from, int max_distance, std::vector<std::pair<StopId, int>>& reached) const;
 
     void AddDistanceStops(std::string_view lhs, std::string_view rhs, int distance);
+    
+    void AddDistanceStops(StopId from, StopId to, int distance);
 
     int GetDistanceStops(std::string_view lhs, std::string_view rhs) const;
     
+    // Расстояние по дороге от from до to; если оно не задано, берётся обратное.
+    int GetDistanceStops(StopId from, StopId to) const;
+    
+    // Маршрут, для перегона которого не задано расстояние, не мешает заморозке:
+    // это отмечается в его BusStat, а маршрутизация и достижимость его не учитывают.
+    void Freeze();
+    
+    bool IsFrozen() const {
+        return is_frozen_;
+    }
+    
+    // Счётчик изменений: растёт при каждом добавлении данных в справочник.
+    uint64_t GetVersion() const {
+        return version_;
+    }
+    
+    const std::deque<Bus>& GetBuses() const {
+        return buses_;
+    }
+    
+    const Stop& GetStop(StopId id) const {
+        return stops_[id];
+    }
+    
+    size_t GetStopCount() const {
+        return stops_.size();
+    }
+    
+    // Координаты всех остановок подряд, индекс совпадает со StopId.
+    std::span<const geo::Coordinates> GetStopCoordinates() const {
+        return stop_coords_;
+    }
+    
+    // Синусы и косинусы координат остановок, индекс совпадает со StopId.
+    const geo::TrigTable& GetStopTrig() const {
+        return stop_trig_;
+    }
+    
+    // Последовательность остановок маршрута, для некольцевого уже развёрнутая туда и обратно.
+    std::span<const StopId> GetRoute(const Bus& bus) const {
+        return std::span<const StopId>(route_stops_).subspan(route_offsets_[bus.id],
+                                                             route_offsets_[bus.id + 1] - route_offsets_[bus.id]);
+    }
+    
+    // Длины перегонов маршрута: элемент i - расстояние от i-й остановки до (i+1)-й.
+    // Доступны после Freeze(); незаданное расстояние записано нулём, см.
+    // BusStat::has_road_distances.
+    std::span<const int> GetRouteDistances(const Bus& bus) const;
+    
+    // Все заданные расстояния; после Freeze() упорядочены по паре остановок.
+    std::span<const RoadDistance> GetRoadDistances() const {
+        return road_distances_;
+    }
+    
+    // Замороженный справочник вместе со всеми индексами, которые строит
+    // Freeze(). Названия заданы номерами в пуле names, автобусы остановок -
+    // номерами автобусов.
+    struct FrozenData {
+        NamePool::Contents names;
+        std::vector<NameId> stop_names;
+        std::vector<geo::Coordinates> stop_coords;
+        geo::TrigTable::Columns stop_trig;
+        SpatialIndex::Contents stop_spatial_index;
+        std::vector<NameId> bus_names;
+        std::vector<uint8_t> bus_is_roundtrip;
+        std::vector<uint32_t> route_offsets;
+        std::vector<StopId> route_stops;
+        std::vector<RoadDistance> road_distances;
+        std::vector<uint32_t> distance_offsets;
+        std::vector<StopId> distance_targets;
+        std::vector<int> distance_values;
+        std::vector<int> route_distances;
+        std::vector<uint32_t> route_link_offsets;
+        std::vector<RouteLink> route_links;
+        std::vector<BusStat> bus_stats;
+        std::vector<uint32_t> stop_bus_offsets;
+        std::vector<BusId> stop_buses;
+        PerfectHashIndex::Table stop_index;
+        PerfectHashIndex::Table bus_index;
+    };
+    
+    // Требует Freeze(), иначе выбрасывает std::logic_error.
+    FrozenData GetFrozenData() const;
+    
+    // Заменяет содержимое справочника данными из GetFrozenData, не перестраивая
+    // индексы; справочник остаётся замороженным. При несогласованных размерах
+    // или номерах вне диапазона выбрасывает std::invalid_argument и не меняется.
+    void Restore(FrozenData data);
+    
 private:
+    void AddBusName(std::string_view busname, bool is_roundtrip);
+    const int* FindDistance(StopId from, StopId to) const;
+    const int* FindDirectedDistance(StopId from, StopId to) const;
+    void BuildDistanceIndex();
+    void BuildRouteDistances();
+    void BuildRouteLinks();
+    void BuildBusStats();
+    void BuildStopBuses();
+    void BuildNameIndex(PerfectHashIndex& index, const std::vector<uint32_t>& name_to_id) const;
     
+    static constexpr uint32_t NO_ID = std::numeric_limits<uint32_t>::max();
     
+    NamePool names_;
+    // Остановка и автобус для каждого названия пула, NO_ID - если их нет.
+    std::vector<StopId> name_to_stop_;
+    std::vector<BusId> name_to_bus_;
+    // Индексы для поиска по названию в замороженном справочнике.
+    PerfectHashIndex stop_index_;
+    PerfectHashIndex bus_index_;
     std::deque<Stop> stops_;
-    std::unordered_map<std::string_view, const Stop*> stopname_to_stop_;
-    std::unordered_map<std::string_view, std::set<const Bus*>> stopname_to_bus_;
+    std::vector<geo::Coordinates> stop_coords_;
+    geo::TrigTable stop_trig_;
+    SpatialIndex stop_spatial_index_;
     std::deque<Bus> buses_;
-    std::unordered_map<std::string_view, const Bus*> busname_to_stop_;
-    std::unordered_map<std::pair<const Stop*, const Stop*>, int, StopDistanceHasher> distance_;
+    // Маршруты всех автобусов в одном массиве: остановки автобуса id лежат
+    // в route_stops_ на отрезке [route_offsets_[id], route_offsets_[id + 1]).
+    std::vector<uint32_t> route_offsets_ = {0};
+    std::vector<StopId> route_stops_;
+    
+    std::vector<RoadDistance> road_distances_;
+    // Заданные расстояния в виде списков смежности: соседи остановки id лежат
+    // на отрезке [distance_offsets_[id], distance_offsets_[id + 1]) по возрастанию StopId.
+    std::vector<uint32_t> distance_offsets_;
+    std::vector<StopId> distance_targets_;
+    std::vector<int> distance_values_;
+    // Длины перегонов, выровненные по route_stops_.
+    std::vector<int> route_distances_;
+    // Перегоны из остановки id - отрезок [route_link_offsets_[id], route_link_offsets_[id + 1]).
+    std::vector<uint32_t> route_link_offsets_;
+    std::vector<RouteLink> route_links_;
+    std::vector<BusStat> bus_stats_;
+    // Автобусы каждой остановки без повторов, по названию: для остановки id
+    // это отрезок [stop_bus_offsets_[id], stop_bus_offsets_[id + 1]) в stop_buses_.
+    std::vector<uint32_t> stop_bus_offsets_;
+    std::vector<const Bus*> stop_buses_;
+    bool is_frozen_ = false;
+    uint64_t version_ = 0;
 };
 
-}
\ No newline at end of file
+}
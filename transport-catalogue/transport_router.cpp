@@ -0,0 +1,136 @@
+#include "transport_router.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace transport_router {
+
+namespace {
+
+// Перевод скорости из км/ч в м/мин.
+constexpr double METERS_PER_MINUTE_IN_KMH = 1000. / 60.;
+
+}  // namespace
+
+RoutingSettings GetRoutingSettings(const json::Dict& routing_settings) {
+    RoutingSettings settings;
+    settings.bus_wait_time = routing_settings.at("bus_wait_time"s).AsInt();
+    settings.bus_velocity = routing_settings.at("bus_velocity"s).AsDouble();
+    CheckRoutingSettings(settings);
+    return settings;
+}
+
+void CheckRoutingSettings(const RoutingSettings& settings) {
+    if (settings.bus_wait_time < 0) {
+        throw std::invalid_argument("bus_wait_time must not be negative"s);
+    }
+    // Условие записано через отрицание, чтобы отсечь и NaN.
+    if (!(settings.bus_velocity > 0.)) {
+        throw std::invalid_argument("bus_velocity must be positive"s);
+    }
+}
+
+TransportRouter::TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, RoutingSettings settings)
+    : catalogue_(catalogue)
+    , settings_(settings)
+    , graph_(BuildGraph())
+    , router_(graph_) {
+}
+
+TransportRouter::TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, RoutingSettings settings,
+                                 graph::Router::Hierarchy hierarchy)
+    : catalogue_(catalogue)
+    , settings_(settings)
+    , graph_(BuildGraph())
+    , router_(graph_, std::move(hierarchy)) {
+}
+
+graph::DirectedWeightedGraph TransportRouter::BuildGraph() {
+    graph::DirectedWeightedGraph result(catalogue_.GetStopCount());
+    const double wait_time = settings_.bus_wait_time;
+    const double meters_per_minute = settings_.bus_velocity * METERS_PER_MINUTE_IN_KMH;
+
+    auto add_edge = [&](graph::VertexId from, graph::VertexId to, double weight, EdgeKind kind, uint32_t id) {
+        result.AddEdge({from, to, weight});
+        edge_infos_.push_back({kind, id});
+    };
+
+    for (const auto& bus : catalogue_.GetBuses()) {
+        const auto route = catalogue_.GetRoute(bus);
+        const auto distances = catalogue_.GetRouteDistances(bus);
+        // По маршруту без расстояний время в пути не определено.
+        if (route.size() < 2 || !catalogue_.GetBusStat(bus).has_road_distances) {
+            continue;
+        }
+        const size_t turn = bus.is_roundtrip ? route.size() - 1 : route.size() / 2;
+        for (const auto& [begin, end] : {std::pair{size_t{0}, turn}, std::pair{turn, route.size() - 1}}) {
+            if (begin == end) {
+                continue;
+            }
+            graph::VertexId previous = 0;
+            for (size_t i = begin; i <= end; ++i) {
+                const graph::VertexId position = result.AddVertex();
+                if (i != end) {
+                    add_edge(route[i], position, wait_time, EdgeKind::WAIT, route[i]);
+                }
+                if (i != begin) {
+                    add_edge(previous, position, distances[i - 1] / meters_per_minute, EdgeKind::RIDE, bus.id);
+                    add_edge(position, route[i], 0., EdgeKind::ALIGHT, 0);
+                }
+                previous = position;
+            }
+        }
+    }
+    return result;
+}
+
+std::optional<RouteInfo> TransportRouter::BuildRoute(std::string_view from, std::string_view to) const {
+    const transport_catalogue::Stop* from_stop = catalogue_.SearchStop(from);
+    const transport_catalogue::Stop* to_stop = catalogue_.SearchStop(to);
+    if (from_stop == nullptr || to_stop == nullptr) {
+        return std::nullopt;
+    }
+    const auto route = router_.BuildRoute(from_stop->id, to_stop->id);
+    if (!route) {
+        return std::nullopt;
+    }
+
+    RouteInfo result;
+    result.total_time = route->weight;
+    for (graph::EdgeId id : route->edges) {
+        const EdgeInfo& info = edge_infos_[id];
+        const double time = graph_.GetEdge(id).weight;
+        if (info.kind == EdgeKind::WAIT) {
+            result.items.push_back(WaitItem{&catalogue_.GetStop(info.id), time});
+            result.items.push_back(BusItem{nullptr, 0, 0.});
+        } else if (info.kind == EdgeKind::RIDE) {
+            BusItem& ride = std::get<BusItem>(result.items.back());
+            ride.bus = &catalogue_.GetBuses()[info.id];
+            ++ride.span_count;
+            ride.time += time;
+        }
+    }
+    return result;
+}
+
+void TransportRouter::FindReachableStops(transport_catalogue::StopId from, double max_time,
+                                         std::vector<std::pair<transport_catalogue::StopId, double>>& reached) const {
+    graph::FindWithin(graph_.GetVertexCount(), from, max_time,
+                      [this](graph::VertexId vertex, const auto& relax) {
+                          for (graph::EdgeId id : graph_.GetIncidentEdges(vertex)) {
+                              const graph::Edge& edge = graph_.GetEdge(id);
+                              relax(edge.to, edge.weight);
+                          }
+                      },
+                      reached);
+    // Первые вершины графа - остановки, остальные - позиции в маршрутах.
+    const size_t stop_count = catalogue_.GetStopCount();
+    reached.erase(std::remove_if(reached.begin(), reached.end(),
+                                 [stop_count](const auto& item) {
+                                     return item.first >= stop_count;
+                                 }),
+                  reached.end());
+}
+
+}  // namespace transport_router
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "graph.h"
+#include "json.h"
+#include "router.h"
+#include "transport_catalogue.h"
+
+namespace transport_router {
+
+struct RoutingSettings {
+    // Ожидание автобуса на остановке, минуты.
+    int bus_wait_time = 0;
+    // Скорость автобуса, км/ч.
+    double bus_velocity = 0.;
+
+    bool operator==(const RoutingSettings&) const = default;
+};
+
+// Выбрасывает std::invalid_argument при отрицательном времени ожидания или
+// неположительной скорости.
+void CheckRoutingSettings(const RoutingSettings& settings);
+
+// Разбирает раздел routing_settings и проверяет его через CheckRoutingSettings.
+RoutingSettings GetRoutingSettings(const json::Dict& routing_settings);
+
+struct WaitItem {
+    const transport_catalogue::Stop* stop;
+    double time;
+};
+
+struct BusItem {
+    const transport_catalogue::Bus* bus;
+    int span_count;
+    double time;
+};
+
+using RouteItem = std::variant<WaitItem, BusItem>;
+
+struct RouteInfo {
+    // Минуты.
+    double total_time = 0.;
+    std::vector<RouteItem> items;
+};
+
+// Самые быстрые маршруты между остановками с ожиданием и поездками на
+// автобусах. Граф строится один раз по замороженному справочнику: вершина на
+// каждую остановку и на каждую позицию в маршруте автобуса. Посадка - ребро
+// остановка -> позиция весом bus_wait_time, проезд перегона - ребро между
+// соседними позициями, выход - ребро позиция -> остановка нулевого веса.
+// Некольцевой маршрут разбит на две цепочки, туда и обратно, поэтому на
+// конечной нужно пересаживаться. Запросы отвечает graph::Router.
+class TransportRouter {
+public:
+    TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, RoutingSettings settings);
+
+    // Не сжимает граф заново, а берёт иерархию, сохранённую GetHierarchy для
+    // того же справочника и настроек; см. graph::Router.
+    TransportRouter(const transport_catalogue::TransportCatalogue& catalogue, RoutingSettings settings,
+                    graph::Router::Hierarchy hierarchy);
+
+    const RoutingSettings& GetSettings() const {
+        return settings_;
+    }
+
+    graph::Router::Hierarchy GetHierarchy() const {
+        return router_.GetHierarchy();
+    }
+
+    // nullopt, если остановки нет или она недостижима. Может вызываться из
+    // нескольких потоков одновременно, пока справочник не меняется.
+    std::optional<RouteInfo> BuildRoute(std::string_view from, std::string_view to) const;
+
+    // Заготовка для времён поездок до набора остановок; см. FindTimes.
+    graph::Router::TargetBuckets PrepareTargets(std::span<const transport_catalogue::StopId> stops) const {
+        return router_.PrepareTargets(stops);
+    }
+
+    // times[i] - время самой быстрой поездки от from до i-й остановки из
+    // targets в минутах, бесконечность - если она недостижима.
+    void FindTimes(transport_catalogue::StopId from, const graph::Router::TargetBuckets& targets,
+                   std::span<double> times) const {
+        router_.FindDistances(from, targets, times);
+    }
+
+    // Остановки, куда можно попасть от from не дольше чем за max_time минут с
+    // учётом ожидания, со временем в пути, ближние первыми. reached
+    // переиспользуется между вызовами.
+    void FindReachableStops(transport_catalogue::StopId from, double max_time,
+                            std::vector<std::pair<transport_catalogue::StopId, double>>& reached) const;
+
+private:
+    enum class EdgeKind : uint8_t {
+        WAIT,
+        RIDE,
+        ALIGHT,
+    };
+
+    // Что означает ребро графа: для WAIT id - остановка, для RIDE - автобус.
+    struct EdgeInfo {
+        EdgeKind kind;
+        uint32_t id;
+    };
+
+    graph::DirectedWeightedGraph BuildGraph();
+
+    const transport_catalogue::TransportCatalogue& catalogue_;
+    RoutingSettings settings_;
+    std::vector<EdgeInfo> edge_infos_;
+    graph::DirectedWeightedGraph graph_;
+    graph::Router router_;
+};
+
+}  // namespace transport_router